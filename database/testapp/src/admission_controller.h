@@ -0,0 +1,153 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_ADMISSION_CONTROLLER_H_  // NOLINT
+#define FIREBASE_TESTAPP_ADMISSION_CONTROLLER_H_  // NOLINT
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "firebase/variant.h"
+
+struct AdmissionOptions {
+  AdmissionOptions()
+      : initial_limit(16),
+        min_limit(1),
+        max_limit(256),
+        target_latency_ms(250),
+        decrease_factor(0.5),
+        max_queued(1024) {}
+
+  // Bounds of the number of operations allowed in flight at once.
+  int initial_limit;
+  int min_limit;
+  int max_limit;
+  // Operations that take longer than this to complete, or that fail, shrink
+  // the limit by decrease_factor. Faster ones grow it by about one per
+  // window's worth of completions.
+  double target_latency_ms;
+  double decrease_factor;
+  // Callers waiting for room beyond this many are rejected.
+  int max_queued;
+};
+
+// A snapshot of the state of an AdmissionController.
+struct AdmissionGauges {
+  AdmissionGauges()
+      : limit(0),
+        in_flight(0),
+        queued(0),
+        admitted(0),
+        rejected(0),
+        completed(0),
+        failed(0),
+        latency_ms(0) {}
+
+  // The current limit, and the operations in flight and waiting for room.
+  int limit;
+  int in_flight;
+  int queued;
+  // Totals since the controller was created.
+  size_t admitted;
+  size_t rejected;
+  size_t completed;
+  size_t failed;
+  // Moving average of the latency of completed operations.
+  double latency_ms;
+};
+
+// Limits how many operations are in flight inside the SDK at once, so that a
+// burst of writes waits (or is turned away) at the caller instead of queueing
+// without bound. The limit adapts to the observed latency: it grows
+// additively while operations complete within the target latency, and is cut
+// multiplicatively when they don't.
+//
+//   AdmissionController controller;
+//   for (...) {
+//     controller.Submit<void>([&]() { return location.SetValue(value); });
+//   }
+//   controller.Drain();
+//
+// Completions are noticed by polling the futures, so that callers remain free
+// to set their own OnCompletion() callbacks. Submit() may be called from any
+// thread.
+class AdmissionController {
+ public:
+  explicit AdmissionController(
+      const AdmissionOptions& options = AdmissionOptions());
+
+  // Calls issue() once there is room for another operation in flight, and
+  // returns the Future it returned. If block is false and there is no room,
+  // or too many callers are already waiting, issue() isn't called and an
+  // invalid Future is returned.
+  template <typename T>
+  firebase::Future<T> Submit(const std::function<firebase::Future<T>()>& issue,
+                             bool block = true) {
+    if (!Acquire(block)) return firebase::Future<T>();
+    firebase::Future<T> future = issue();
+    Track(future);
+    return future;
+  }
+
+  // Retires completed operations and adapts the limit.
+  void Poll();
+  // Waits for every operation in flight to complete.
+  void Drain();
+
+  AdmissionGauges gauges();
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Operation {
+    firebase::FutureBase future;
+    Clock::time_point start;
+  };
+
+  // Reserves room for an operation, waiting for it if block is true.
+  bool Acquire(bool block);
+  // Starts tracking the operation that Acquire() reserved room for.
+  void Track(const firebase::FutureBase& future);
+  void PollLocked();
+  bool HasRoomLocked() const;
+
+  AdmissionOptions options_;
+  std::mutex mutex_;
+  double limit_;
+  std::list<Operation> in_flight_;
+  // Operations that have been admitted but not issued yet.
+  int reserved_;
+  int queued_;
+  // Only operations issued after the last decrease can cause another, so
+  // that one slow window isn't counted once per operation.
+  Clock::time_point last_decrease_;
+  AdmissionGauges totals_;
+};
+
+// Writes through controller, see AdmissionController::Submit().
+firebase::Future<void> AdmittedSetValue(
+    AdmissionController* controller,
+    firebase::database::DatabaseReference location,
+    const firebase::Variant& value, bool block = true);
+firebase::Future<void> AdmittedUpdateChildren(
+    AdmissionController* controller,
+    firebase::database::DatabaseReference location,
+    const firebase::Variant& values, bool block = true);
+
+#endif  // FIREBASE_TESTAPP_ADMISSION_CONTROLLER_H_  // NOLINT
@@ -0,0 +1,82 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmarks.h"  // NOLINT
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+// Returns the latency below which fraction of the sorted latencies fall.
+double Percentile(const std::vector<double>& sorted, double fraction) {
+  size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}  // namespace
+
+void LogLatencies(const char* name, std::vector<double> latencies) {
+  if (latencies.empty()) {
+    LogMessage("  %s: no samples.", name);
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (size_t i = 0; i < latencies.size(); i++) total += latencies[i];
+  LogMessage(
+      "  %s: %d samples, mean %.1f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, "
+      "max %.1f ms.",
+      name, static_cast<int>(latencies.size()),
+      total / latencies.size() * 1000.0, Percentile(latencies, 0.5) * 1000.0,
+      Percentile(latencies, 0.95) * 1000.0,
+      Percentile(latencies, 0.99) * 1000.0, latencies.back() * 1000.0);
+}
+
+firebase::Variant MakeSyntheticSnapshot(int records) {
+  static const char* kCities[] = {"Mountain View", "London", "Tokyo",
+                                  "S\xc3\xa3o Paulo", "Z\xc3\xbcrich"};
+  firebase::Variant snapshot = firebase::Variant::EmptyMap();
+  for (int i = 0; i < records; i++) {
+    char key[32];
+    snprintf(key, sizeof(key), "user_%06d", i);
+    char name[64];
+    snprintf(name, sizeof(name), "User %d", i);
+    firebase::Variant address = firebase::Variant::EmptyMap();
+    address.map()["street"] = std::to_string(i % 1000) + " Main Street";
+    address.map()["city"] = kCities[i % 5];
+    address.map()["zip"] = static_cast<int64_t>(10000 + i % 90000);
+    firebase::Variant tags = firebase::Variant::EmptyVector();
+    tags.vector().push_back("tag" + std::to_string(i % 7));
+    tags.vector().push_back("tag" + std::to_string(i % 11));
+    tags.vector().push_back(i % 3 == 0);
+    firebase::Variant record = firebase::Variant::EmptyMap();
+    record.map()["name"] = std::string(name);
+    record.map()["bio"] =
+        "Likes long walks, \"quoted\" phrases and C:\\paths.\nSecond line "
+        "of a description that is long enough to be worth scanning quickly.";
+    record.map()["age"] = static_cast<int64_t>(18 + i % 60);
+    record.map()["score"] = i * 0.37;
+    record.map()["active"] = i % 2 == 0;
+    record.map()["address"] = address;
+    record.map()["tags"] = tags;
+    snapshot.map()[std::string(key)] = record;
+  }
+  return snapshot;
+}
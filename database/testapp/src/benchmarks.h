@@ -0,0 +1,82 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_BENCHMARKS_H_  // NOLINT
+#define FIREBASE_TESTAPP_BENCHMARKS_H_  // NOLINT
+
+#include <vector>
+
+#include "firebase/database.h"
+#include "firebase/variant.h"
+
+// Benchmarks run by the desktop testapp with "--benchmark=name". Each one logs
+// its measurements and returns false if it couldn't complete.
+
+// Returns the value of a "--name=value" command line argument, or nullptr if
+// it wasn't given.
+const char* GetArgument(int argc, const char* argv[], const char* name);
+
+// Logs the count, mean and percentiles of latencies, given in seconds, as
+// "  name: ...".
+void LogLatencies(const char* name, std::vector<double> latencies);
+
+// Builds a snapshot shaped like a typical user collection, with records keyed
+// "user_000000" and up, holding a mix of short and long strings (some of which
+// need escaping), numbers, a nested map and a vector.
+firebase::Variant MakeSyntheticSnapshot(int records);
+
+// "--benchmark=json": compares VariantToJson() and JsonToVariant() with a
+// straightforward recursive codec on a synthesized snapshot. Runs locally,
+// without touching the database.
+bool RunJsonCodecBenchmark(firebase::database::Database* database, int argc,
+                           const char* argv[]);
+
+// "--benchmark=counter": increments a counter from several threads at once,
+// first as a single node and then as a ShardedCounter, and reports the commit
+// rate and how often transactions were retried.
+bool RunCounterBenchmark(firebase::database::Database* database, int argc,
+                         const char* argv[]);
+
+// "--benchmark=offline": queues writes while offline, measuring how the
+// memory and on-disk persistence of the write queue grow, then goes online and
+// measures how quickly the queue is replayed. Runs with persistence enabled.
+bool RunOfflineBenchmark(firebase::database::Database* database, int argc,
+                         const char* argv[]);
+
+// "--benchmark=presence": connects many simulated clients, each with its own
+// App, registers their Presence, then disconnects them all. Reports how long
+// registration took and how long the server took to remove each client's
+// presence after it disconnected.
+bool RunPresenceBenchmark(firebase::database::Database* database, int argc,
+                          const char* argv[]);
+
+// "--benchmark=prefetch": reads a skewed sequence of locations, first cold and
+// then with a PrefetchPlanner keeping them synced within a memory budget, and
+// reports the hit rate and the latency of hits and misses.
+bool RunPrefetchBenchmark(firebase::database::Database* database, int argc,
+                          const char* argv[]);
+
+// "--benchmark=flat": keeps copies of a synthesized snapshot as Variants and as
+// FlatSnapshots, and compares their memory use and how quickly they are
+// copied, walked and searched. Runs locally, without touching the database.
+bool RunFlatSnapshotBenchmark(firebase::database::Database* database,
+                              int argc, const char* argv[]);
+
+// "--benchmark=fanout": writes a post to the feeds of 10, 100, 1000 and 10000
+// followers with WriteFanout(), and reports the number and latency of the
+// chunks, the throughput, and how long the copies were inconsistent.
+bool RunFanoutBenchmark(firebase::database::Database* database, int argc,
+                        const char* argv[]);
+
+#endif  // FIREBASE_TESTAPP_BENCHMARKS_H_  // NOLINT
@@ -0,0 +1,336 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bulk_importer.h"  // NOLINT
+
+#include <chrono>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "firebase/future.h"
+#include "firebase/variant.h"
+#include "json_reader.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// How often progress is logged, in bytes of JSON read.
+const size_t kProgressIntervalBytes = 16 * 1024 * 1024;
+// How long to sleep while waiting for writes to complete.
+const int kPollMs = 1;
+
+// Whether a write that failed with error may succeed if it is made again.
+bool IsRetryable(firebase::database::Error error) {
+  switch (error) {
+    case firebase::database::kErrorDisconnected:
+    case firebase::database::kErrorNetworkError:
+    case firebase::database::kErrorUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// A group of paths written with a single UpdateChildren() call.
+struct Chunk {
+  Chunk() : bytes(0), paths(0), attempts(0) {}
+
+  firebase::Variant values;
+  size_t bytes;
+  size_t paths;
+  int attempts;
+  firebase::Future<void> future;
+  // When a failed chunk may be written again.
+  Clock::time_point retry_time;
+};
+
+class BulkImporter {
+ public:
+  BulkImporter(const firebase::database::DatabaseReference& destination,
+               const BulkImportOptions& options, BulkImportStats* stats)
+      : destination_(destination),
+        options_(options),
+        stats_(stats),
+        in_flight_bytes_(0) {
+    chunk_.values = firebase::Variant::EmptyMap();
+  }
+
+  // Adds value, which was bytes of JSON, to the chunk being built, and writes
+  // the chunk once it is full.
+  void Add(const std::string& path, firebase::Variant value, size_t bytes) {
+    chunk_.values.map()[firebase::Variant(path)] = std::move(value);
+    chunk_.paths++;
+    chunk_.bytes += bytes;
+    if (chunk_.bytes >= options_.chunk_bytes) Flush();
+  }
+
+  // Writes the chunk being built.
+  void Flush() {
+    if (!chunk_.paths) return;
+    Submit(&chunk_);
+    chunk_ = Chunk();
+    chunk_.values = firebase::Variant::EmptyMap();
+  }
+
+  // Writes the chunk being built and waits for every chunk to complete.
+  void Drain() {
+    Flush();
+    while (!in_flight_.empty()) {
+      if (!Poll()) ProcessEvents(kPollMs);
+    }
+  }
+
+ private:
+  // Writes chunk, first waiting for earlier chunks to complete if there isn't
+  // room for it in the window.
+  void Submit(Chunk* chunk) {
+    while (!in_flight_.empty() &&
+           in_flight_bytes_ + chunk->bytes > options_.max_in_flight_bytes) {
+      if (!Poll()) ProcessEvents(kPollMs);
+    }
+    in_flight_bytes_ += chunk->bytes;
+    in_flight_.push_back(Chunk());
+    Chunk& submitted = in_flight_.back();
+    std::swap(submitted.values, chunk->values);
+    submitted.bytes = chunk->bytes;
+    submitted.paths = chunk->paths;
+    Write(&submitted);
+    Poll();
+  }
+
+  void Write(Chunk* chunk) {
+    chunk->attempts++;
+    chunk->future = destination_.UpdateChildren(chunk->values);
+  }
+
+  // Retires completed chunks and reissues failed ones. Returns whether any
+  // progress was made.
+  bool Poll() {
+    bool progress = false;
+    Clock::time_point now = Clock::now();
+    for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+      Chunk& chunk = *it;
+      if (chunk.future.status() == firebase::kFutureStatusPending) {
+        ++it;
+        continue;
+      }
+      if (chunk.future.status() == firebase::kFutureStatusInvalid) {
+        // Waiting for a retry.
+        if (now >= chunk.retry_time) {
+          stats_->retries++;
+          Write(&chunk);
+          progress = true;
+        }
+        ++it;
+        continue;
+      }
+      progress = true;
+      firebase::database::Error error =
+          static_cast<firebase::database::Error>(chunk.future.error());
+      if (error == firebase::database::kErrorNone) {
+        stats_->bytes += chunk.bytes;
+        stats_->paths += chunk.paths;
+        stats_->chunks++;
+      } else if (IsRetryable(error) &&
+                 chunk.attempts < options_.max_attempts) {
+        LogMessage("  Chunk of %d paths failed with error %d: %s, retrying.",
+                   static_cast<int>(chunk.paths), error,
+                   chunk.future.error_message());
+        chunk.future.Release();
+        chunk.retry_time =
+            now + std::chrono::milliseconds(options_.retry_delay_ms
+                                            << (chunk.attempts - 1));
+        ++it;
+        continue;
+      } else {
+        LogMessage("ERROR: Chunk of %d paths failed with error %d: %s",
+                   static_cast<int>(chunk.paths), error,
+                   chunk.future.error_message());
+        stats_->failed_chunks++;
+      }
+      in_flight_bytes_ -= chunk.bytes;
+      it = in_flight_.erase(it);
+    }
+    return progress;
+  }
+
+  firebase::database::DatabaseReference destination_;
+  const BulkImportOptions& options_;
+  BulkImportStats* stats_;
+  // The chunk being built.
+  Chunk chunk_;
+  std::list<Chunk> in_flight_;
+  size_t in_flight_bytes_;
+};
+
+// Reads the members of the top level object and adds them to a BulkImporter.
+// A member whose JSON is larger than a chunk is read a member at a time
+// instead, down to the objects that fit in a chunk, which are added at their
+// own paths, e.g. users/<id>.
+class MemberReader {
+ public:
+  MemberReader(JsonReader* reader, BulkImporter* importer,
+               const BulkImportOptions& options, BulkImportStats* stats)
+      : reader_(reader),
+        importer_(importer),
+        options_(options),
+        stats_(stats),
+        start_(Clock::now()),
+        next_progress_(kProgressIntervalBytes),
+        split_(false) {}
+
+  // Reads the next member of the top level object and adds it to the
+  // importer. Returns false at the end of the object or on a parse error.
+  bool Next() {
+    if (!reader_->NextKey(&member_)) return false;
+    split_ = false;
+    size_t start = reader_->position();
+    firebase::Variant value;
+    bool written = false;
+    if (!Read(member_, &value, &written)) return false;
+    if (!written) {
+      importer_->Add(member_, std::move(value), reader_->position() - start);
+    }
+    return true;
+  }
+
+ private:
+  // A member of an object, read whole.
+  struct Member {
+    Member() : bytes(0) {}
+
+    std::string key;
+    firebase::Variant value;
+    size_t bytes;
+  };
+
+  // Reads the value at path. If it fits in a chunk, it's returned in *value.
+  // Otherwise it has been added to the importer a descendant at a time, and
+  // *written is set.
+  bool Read(const std::string& path, firebase::Variant* value,
+            bool* written) {
+    if (!reader_->AtObject()) {
+      bool read = reader_->ReadValue(value);
+      LogProgress();
+      return read;
+    }
+    size_t start = reader_->position();
+    if (!reader_->BeginObject()) return false;
+    // The members read so far, until the object turns out to be too large.
+    std::vector<Member> members;
+    bool split = false;
+    std::string key;
+    while (reader_->NextKey(&key)) {
+      size_t member_start = reader_->position();
+      firebase::Variant member;
+      bool member_written = false;
+      std::string member_path = path + "/" + key;
+      if (!Read(member_path, &member, &member_written)) return false;
+      if (!member_written) {
+        members.push_back(Member());
+        members.back().key = key;
+        members.back().value = std::move(member);
+        members.back().bytes = reader_->position() - member_start;
+      }
+      if (!split && (member_written ||
+                     reader_->position() - start > options_.chunk_bytes)) {
+        split = true;
+        Split();
+      }
+      if (split) {
+        for (auto& read : members) {
+          importer_->Add(path + "/" + read.key, std::move(read.value),
+                         read.bytes);
+        }
+        members.clear();
+      }
+    }
+    if (reader_->has_error()) return false;
+    if (split) {
+      *written = true;
+      return true;
+    }
+    *value = firebase::Variant::EmptyMap();
+    for (auto& read : members) {
+      value->map()[firebase::Variant(read.key)] = std::move(read.value);
+    }
+    return true;
+  }
+
+  // Called before the first path under the current top level member is
+  // added. A whole member replaces the data at its path, so remove that data
+  // first, and wait for the removal to be written, as a retry of it would
+  // otherwise remove the paths written after it.
+  void Split() {
+    if (split_) return;
+    split_ = true;
+    stats_->split_members++;
+    importer_->Add(member_, firebase::Variant::Null(), 0);
+    importer_->Drain();
+  }
+
+  void LogProgress() {
+    if (reader_->position() < next_progress_) return;
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - start_).count();
+    LogMessage("  Read %.1f MB, written %.1f MB (%.2f MB/s).",
+               reader_->position() / (1024.0 * 1024.0),
+               stats_->bytes / (1024.0 * 1024.0),
+               seconds > 0 ? stats_->bytes / (1024.0 * 1024.0) / seconds : 0);
+    next_progress_ += kProgressIntervalBytes;
+  }
+
+  JsonReader* reader_;
+  BulkImporter* importer_;
+  const BulkImportOptions& options_;
+  BulkImportStats* stats_;
+  Clock::time_point start_;
+  size_t next_progress_;
+  // The key of the top level member being read, and whether it was split.
+  std::string member_;
+  bool split_;
+};
+
+}  // namespace
+
+bool ImportJson(const char* path,
+                const firebase::database::DatabaseReference& destination,
+                const BulkImportOptions& options, BulkImportStats* stats) {
+  *stats = BulkImportStats();
+  Clock::time_point start = Clock::now();
+  JsonReader reader;
+  if (!reader.Open(path) || !reader.BeginObject()) {
+    LogMessage("ERROR: %s", reader.error().c_str());
+    return false;
+  }
+
+  BulkImporter importer(destination, options, stats);
+  MemberReader members(&reader, &importer, options, stats);
+  while (members.Next()) {
+  }
+  importer.Drain();
+  stats->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (reader.has_error()) {
+    LogMessage("ERROR: %s", reader.error().c_str());
+    return false;
+  }
+  return stats->failed_chunks == 0;
+}
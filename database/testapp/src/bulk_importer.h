@@ -0,0 +1,85 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_BULK_IMPORTER_H_  // NOLINT
+#define FIREBASE_TESTAPP_BULK_IMPORTER_H_  // NOLINT
+
+#include <cstddef>
+
+#include "firebase/database.h"
+
+struct BulkImportOptions {
+  BulkImportOptions()
+      : chunk_bytes(256 * 1024),
+        max_in_flight_bytes(4 * 1024 * 1024),
+        max_attempts(4),
+        retry_delay_ms(500) {}
+
+  // Members of the top level object are grouped into UpdateChildren() calls
+  // of roughly this many bytes of JSON. A member larger than this is written
+  // at the paths of its descendants instead, e.g. users/<id>, so that no more
+  // than about this much of it is held in memory.
+  size_t chunk_bytes;
+  // Reading stops while this many bytes of JSON are waiting to be written.
+  size_t max_in_flight_bytes;
+  // Number of times a chunk is written before the import gives up on it.
+  // Only errors that may be transient, such as a lost connection, are
+  // retried.
+  int max_attempts;
+  // Delay before a failed chunk is retried, doubled after each attempt.
+  int retry_delay_ms;
+};
+
+struct BulkImportStats {
+  BulkImportStats()
+      : bytes(0),
+        paths(0),
+        split_members(0),
+        chunks(0),
+        retries(0),
+        failed_chunks(0),
+        seconds(0) {}
+
+  double megabytes_per_second() const {
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+  }
+
+  // Bytes of JSON written successfully.
+  size_t bytes;
+  // Paths written successfully: members of the top level object, or the
+  // descendants of the members that were split.
+  size_t paths;
+  // Members of the top level object too large for a chunk, which were written
+  // at the paths of their descendants.
+  size_t split_members;
+  // UpdateChildren() calls that succeeded.
+  size_t chunks;
+  // UpdateChildren() calls that failed and were issued again.
+  size_t retries;
+  // Chunks that still failed after max_attempts.
+  size_t failed_chunks;
+  double seconds;
+};
+
+// Writes each member of the top level object of the JSON file at path to the
+// child of destination with the same key, replacing any existing data there.
+// The file is streamed rather than loaded, and several UpdateChildren() calls
+// are kept in flight at once. A member too large for a chunk is written once
+// its existing data has been removed. Returns false if the file couldn't be
+// parsed or any chunk couldn't be written.
+bool ImportJson(const char* path,
+                const firebase::database::DatabaseReference& destination,
+                const BulkImportOptions& options, BulkImportStats* stats);
+
+#endif  // FIREBASE_TESTAPP_BULK_IMPORTER_H_  // NOLINT
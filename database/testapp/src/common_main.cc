@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include "firebase/app.h"
 #include "firebase/auth.h"
@@ -21,7 +25,21 @@
 #include "firebase/util.h"
 
 // Thin OS abstraction layer.
-#include "main.h"  // NOLINT
+#include "admission_controller.h"      // NOLINT
+#include "benchmarks.h"                // NOLINT
+#include "bulk_importer.h"             // NOLINT
+#include "fanout_writer.h"             // NOLINT
+#include "flat_snapshot.h"             // NOLINT
+#include "instrumented_transaction.h"  // NOLINT
+#include "json_exporter.h"             // NOLINT
+#include "local_index.h"               // NOLINT
+#include "main.h"                      // NOLINT
+#include "paginated_reader.h"          // NOLINT
+#include "prefetch_planner.h"          // NOLINT
+#include "presence.h"                  // NOLINT
+#include "query_cache.h"               // NOLINT
+#include "sharded_counter.h"           // NOLINT
+#include "snapshot_diff.h"             // NOLINT
 
 // An example of a ValueListener object. This specific version will
 // simply log every value it sees, and store them in a list so we can
@@ -141,6 +159,108 @@ void WaitForCompletion(const firebase::FutureBase& future, const char* name) {
   }
 }
 
+const char* GetArgument(int argc, const char* argv[], const char* name) {
+  size_t name_length = strlen(name);
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--", 2) == 0 &&
+        strncmp(arg + 2, name, name_length) == 0 &&
+        arg[2 + name_length] == '=') {
+      return arg + 2 + name_length + 1;
+    }
+  }
+  return nullptr;
+}
+
+// Loads the JSON file given by "--import=file.json" into the database at
+// "--import_path=path", or "import" if no path is given.
+bool RunImport(firebase::database::Database* database, int argc,
+               const char* argv[]) {
+  const char* path = GetArgument(argc, argv, "import_path");
+  if (!path) path = "import";
+  BulkImportOptions options;
+  const char* chunk_bytes = GetArgument(argc, argv, "import_chunk_bytes");
+  if (chunk_bytes) options.chunk_bytes = strtoul(chunk_bytes, nullptr, 10);
+  const char* window_bytes = GetArgument(argc, argv, "import_window_bytes");
+  if (window_bytes) {
+    options.max_in_flight_bytes = strtoul(window_bytes, nullptr, 10);
+  }
+  const char* file = GetArgument(argc, argv, "import");
+  LogMessage("Importing %s into %s.", file, path);
+
+  BulkImportStats stats;
+  bool success =
+      ImportJson(file, database->GetReference(path), options, &stats);
+  LogMessage(
+      "Imported %d paths (%d members split, %.1f MB) in %d chunks in %.1f s: "
+      "%.2f MB/s, %d retries, %d failed chunks.",
+      static_cast<int>(stats.paths), static_cast<int>(stats.split_members),
+      stats.bytes / (1024.0 * 1024.0),
+      static_cast<int>(stats.chunks), stats.seconds,
+      stats.megabytes_per_second(), static_cast<int>(stats.retries),
+      static_cast<int>(stats.failed_chunks));
+  LogMessage(success ? "SUCCESS: Import complete." : "ERROR: Import failed.");
+  return success;
+}
+
+// Writes the data at "--export_path=path" to the file given by
+// "--export=file.json". The output is compressed if the file name ends in
+// ".gz".
+bool RunExport(firebase::database::Database* database, int argc,
+               const char* argv[]) {
+  const char* file = GetArgument(argc, argv, "export");
+  const char* path = GetArgument(argc, argv, "export_path");
+  if (!path) path = "";
+  JsonExportOptions options;
+  const char* page_size = GetArgument(argc, argv, "export_page_size");
+  if (page_size) options.page_size = strtoul(page_size, nullptr, 10);
+  size_t file_length = strlen(file);
+  options.gzip = file_length > 3 && strcmp(file + file_length - 3, ".gz") == 0;
+  LogMessage("Exporting /%s to %s.", path, file);
+
+  JsonExportStats stats;
+  bool success =
+      ExportJson(database->GetReference(path), file, options, &stats);
+  LogMessage(
+      "Exported %d children (%.1f MB) in %d pages in %.1f s: %.2f MB/s.",
+      static_cast<int>(stats.children), stats.bytes / (1024.0 * 1024.0),
+      static_cast<int>(stats.pages), stats.seconds,
+      stats.megabytes_per_second());
+  LogMessage(success ? "SUCCESS: Export complete." : "ERROR: Export failed.");
+  return success;
+}
+
+// Runs the benchmark given by "--benchmark=name".
+bool RunBenchmark(firebase::database::Database* database, int argc,
+                  const char* argv[]) {
+  const char* name = GetArgument(argc, argv, "benchmark");
+  if (strcmp(name, "json") == 0) {
+    return RunJsonCodecBenchmark(database, argc, argv);
+  } else if (strcmp(name, "counter") == 0) {
+    return RunCounterBenchmark(database, argc, argv);
+  } else if (strcmp(name, "offline") == 0) {
+    return RunOfflineBenchmark(database, argc, argv);
+  } else if (strcmp(name, "presence") == 0) {
+    return RunPresenceBenchmark(database, argc, argv);
+  } else if (strcmp(name, "prefetch") == 0) {
+    return RunPrefetchBenchmark(database, argc, argv);
+  } else if (strcmp(name, "flat") == 0) {
+    return RunFlatSnapshotBenchmark(database, argc, argv);
+  } else if (strcmp(name, "fanout") == 0) {
+    return RunFanoutBenchmark(database, argc, argv);
+  }
+  LogMessage("ERROR: Unknown benchmark %s.", name);
+  return false;
+}
+
+// Returns whether the command line asks for one of the desktop tools rather
+// than the tests.
+bool RunningTool(int argc, const char* argv[]) {
+  return GetArgument(argc, argv, "import") ||
+         GetArgument(argc, argv, "export") ||
+         GetArgument(argc, argv, "benchmark");
+}
+
 extern "C" int common_main(int argc, const char* argv[]) {
   ::firebase::App* app;
 
@@ -158,7 +278,9 @@ extern "C" int common_main(int argc, const char* argv[]) {
   // dependencies are missing.
   ::firebase::database::Database* database = nullptr;
   ::firebase::auth::Auth* auth = nullptr;
-  void* initialize_targets[] = {&auth, &database};
+  // "--database_url=url" connects to another database, such as the emulator.
+  const char* database_url = GetArgument(argc, argv, "database_url");
+  void* initialize_targets[] = {&auth, &database, &database_url};
 
   const firebase::ModuleInitializer::InitializerFn initializers[] = {
       [](::firebase::App* app, void* data) {
@@ -173,8 +295,11 @@ extern "C" int common_main(int argc, const char* argv[]) {
         LogMessage("Attempt to initialize Firebase Database.");
         void** targets = reinterpret_cast<void**>(data);
         ::firebase::InitResult result;
+        const char* url = *reinterpret_cast<const char**>(targets[2]);
         *reinterpret_cast<::firebase::database::Database**>(targets[1]) =
-            ::firebase::database::Database::GetInstance(app, &result);
+            url ? ::firebase::database::Database::GetInstance(app, url,
+                                                              &result)
+                : ::firebase::database::Database::GetInstance(app, &result);
         return result;
       }};
 
@@ -192,7 +317,13 @@ extern "C" int common_main(int argc, const char* argv[]) {
   }
   LogMessage("Successfully initialized Firebase Auth and Firebase Database.");
 
-  database->set_persistence_enabled(true);
+  // The desktop tools skip persistence, which would otherwise copy all of the
+  // data they move to disk, except for the offline benchmark which measures
+  // it.
+  const char* benchmark = GetArgument(argc, argv, "benchmark");
+  database->set_persistence_enabled(
+      !RunningTool(argc, argv) ||
+      (benchmark && strcmp(benchmark, "offline") == 0));
 
   // Sign in using Auth before accessing the database.
   // The default Database permissions allow anonymous users access. This will
@@ -216,6 +347,21 @@ extern "C" int common_main(int argc, const char* argv[]) {
     }
   }
 
+  if (RunningTool(argc, argv)) {
+    bool success;
+    if (GetArgument(argc, argv, "import")) {
+      success = RunImport(database, argc, argv);
+    } else if (GetArgument(argc, argv, "export")) {
+      success = RunExport(database, argc, argv);
+    } else {
+      success = RunBenchmark(database, argc, argv);
+    }
+    delete database;
+    delete auth;
+    delete app;
+    return success ? 0 : 1;
+  }
+
   std::string saved_url;  // persists across connections
 
   // Create a unique child in the database that we can run our tests in.
@@ -511,6 +657,111 @@ extern "C" int common_main(int argc, const char* argv[]) {
     }
   }
 
+  // Test an instrumented transaction: one that commits, checking that the
+  // stats account for it, and one that the transaction function aborts.
+  {
+    LogMessage("TEST: Instrumented transaction.");
+    TransactionBackoff backoff;
+    TransactionStats stats;
+    firebase::database::DataSnapshot result;
+    firebase::database::Error error = RunInstrumentedTransaction(
+        ref.Child("InstrumentedTransaction"),
+        [](firebase::database::MutableData* data) {
+          data->set_value(data->value().AsInt64().int64_value() + 1);
+          return firebase::database::kTransactionResultSuccess;
+        },
+        backoff, &stats, &result);
+    LogTransactionStats("Increment", stats);
+    bool success = error == firebase::database::kErrorNone &&
+                   stats.committed && stats.runs == 1 && stats.attempts >= 1;
+    if (!success) {
+      LogMessage("ERROR: Instrumented transaction returned error %d.", error);
+    }
+
+    error = RunInstrumentedTransaction(
+        ref.Child("InstrumentedTransaction"),
+        [](firebase::database::MutableData*) {
+          return firebase::database::kTransactionResultAbort;
+        },
+        backoff, &stats, nullptr);
+    LogTransactionStats("Abort", stats);
+    if (error != firebase::database::kErrorTransactionAbortedByUser ||
+        stats.committed || stats.user_aborts != 1 || stats.runs != 1) {
+      LogMessage("ERROR: Aborted instrumented transaction returned error %d.",
+                 error);
+      success = false;
+    }
+    if (success) LogMessage("SUCCESS: Instrumented transaction test passed.");
+  }
+
+  // Test the admission controller: a burst of writes never has more than the
+  // limit in flight, and every write completes.
+  {
+    LogMessage("TEST: Admission controller.");
+    static const int kWrites = 40;
+    static const int kLimit = 4;
+    AdmissionOptions options;
+    options.initial_limit = kLimit;
+    options.max_limit = kLimit;
+    AdmissionController controller(options);
+    std::vector<firebase::Future<void>> writes;
+    int max_in_flight = 0;
+    for (int i = 0; i < kWrites; i++) {
+      writes.push_back(AdmittedSetValue(
+          &controller, ref.Child("Admission").Child(std::to_string(i)), i));
+      max_in_flight = std::max(max_in_flight, controller.gauges().in_flight);
+    }
+    controller.Drain();
+    bool written = true;
+    for (size_t i = 0; i < writes.size(); i++) {
+      written = written &&
+                writes[i].status() == firebase::kFutureStatusComplete &&
+                writes[i].error() == firebase::database::kErrorNone;
+    }
+    AdmissionGauges gauges = controller.gauges();
+    LogMessage("  Limit %d, %d admitted, %d completed, %.1f ms latency.",
+               gauges.limit, static_cast<int>(gauges.admitted),
+               static_cast<int>(gauges.completed), gauges.latency_ms);
+    if (!written || gauges.completed != kWrites) {
+      LogMessage("ERROR: Admitted writes failed.");
+    } else if (max_in_flight > kLimit) {
+      LogMessage("ERROR: %d writes were in flight, over the limit of %d.",
+                 max_in_flight, kLimit);
+    } else {
+      LogMessage("SUCCESS: Admission controller test passed.");
+    }
+  }
+
+  // Test a sharded counter. Increments are issued without waiting, so that
+  // they run concurrently, and the total must account for all of them.
+  {
+    LogMessage("TEST: Sharded counter.");
+    static const int kIncrements = 10;
+    ShardedCounter counter(ref.Child("ShardedCounter"), 4);
+    std::vector<firebase::Future<firebase::database::DataSnapshot>> futures;
+    for (int i = 0; i < kIncrements; i++) {
+      futures.push_back(counter.Increment(1));
+    }
+    bool committed = true;
+    for (size_t i = 0; i < futures.size(); i++) {
+      WaitForCompletion(futures[i], "ShardedCounterIncrement");
+      committed = committed &&
+                  futures[i].error() == firebase::database::kErrorNone;
+    }
+    firebase::Future<firebase::database::DataSnapshot> read_future =
+        counter.Read();
+    WaitForCompletion(read_future, "ShardedCounterRead");
+    if (!committed || read_future.error() != firebase::database::kErrorNone) {
+      LogMessage("ERROR: Sharded counter increments failed.");
+    } else if (ShardedCounter::Sum(*read_future.result()) != kIncrements) {
+      LogMessage("ERROR: Sharded counter is %lld, expected %d.",
+                 ShardedCounter::Sum(*read_future.result()), kIncrements);
+    } else {
+      LogMessage("SUCCESS: Sharded counter test succeeded (%lld attempts).",
+                 counter.attempts());
+    }
+  }
+
   // Set up a map of values that we will put into the database, then modify.
   std::map<std::string, int> sample_values;
   sample_values.insert(std::make_pair("Apple", 1));
@@ -595,6 +846,49 @@ extern "C" int common_main(int argc, const char* argv[]) {
     }
   }
 
+  // Test WriteFanout, which writes a copy of a payload to many paths.
+  {
+    LogMessage("TEST: Fan-out writer.");
+    std::vector<std::string> paths;
+    for (int i = 0; i < 5; i++) {
+      paths.push_back("feeds/user_" + std::to_string(i) + "/post_1");
+    }
+    std::map<std::string, firebase::Variant> post;
+    post["author"] = "Tom";
+    post["text"] = "Hello";
+
+    // A fan-out that fits in one update is atomic, a smaller chunk size
+    // splits it.
+    FanoutOptions options;
+    FanoutResult atomic;
+    bool failed = !WriteFanout(ref.Child("Fanout"), paths, post, options,
+                               &atomic) ||
+                  !atomic.atomic();
+    options.chunk_bytes = 100;
+    FanoutResult chunked;
+    failed = !WriteFanout(ref.Child("Fanout"), paths, post, options,
+                          &chunked) ||
+             chunked.atomic() || failed;
+    LogMessage("  Fan-out: %d chunk(s) in %.1f ms, then %d in %.1f ms.",
+               static_cast<int>(atomic.chunks.size()), atomic.seconds * 1000.0,
+               static_cast<int>(chunked.chunks.size()),
+               chunked.seconds * 1000.0);
+
+    firebase::Future<firebase::database::DataSnapshot> feeds =
+        ref.Child("Fanout").Child("feeds").GetValue();
+    WaitForCompletion(feeds, "GetFanout");
+    if (feeds.error() != firebase::database::kErrorNone ||
+        feeds.result()->children_count() != paths.size() ||
+        feeds.result()->Child("user_4/post_1/text").value() != "Hello") {
+      failed = true;
+    }
+    if (!failed) {
+      LogMessage("SUCCESS: Fan-out writer wrote every copy.");
+    } else {
+      LogMessage("ERROR: Fan-out writer didn't write every copy.");
+    }
+  }
+
   // Test Query, which gives you different views into the same location in the
   // database.
   {
@@ -677,6 +971,228 @@ extern "C" int common_main(int argc, const char* argv[]) {
     }
   }
 
+  // Test QueryCache, which answers repeated identical queries locally and
+  // drops the results that a change to the data at the location affects.
+  {
+    LogMessage("TEST: Query cache.");
+    QueryCache* cache = new QueryCache(ref.Child("QueryFiltering"));
+
+    // The cache's listener reports the existing children when it's attached.
+    // Wait for here for a moment for the initial values to be received.
+    ProcessEvents(2000);
+
+    const QuerySpec specs[] = {
+        QuerySpec().OrderByKey().StartAt("B").EndAt("Dz"),
+        QuerySpec().OrderByValue().StartAt(1).EndAt(3),
+        QuerySpec().OrderByValue().LimitToLast(2),
+        QuerySpec().OrderByKey().LimitToFirst(2),
+        QuerySpec().OrderByKey().EqualTo("Cranberry"),
+    };
+    const size_t kNumSpecs = sizeof(specs) / sizeof(specs[0]);
+    const size_t kExpectedCounts[] = {3, 3, 2, 2, 1};
+
+    bool failed = false;
+    for (int round = 0; round < 2; round++) {
+      for (size_t i = 0; i < kNumSpecs; i++) {
+        auto future = cache->GetValue(specs[i]);
+        WaitForCompletion(future, "QueryCacheGetValue");
+        if (future.error() != firebase::database::kErrorNone ||
+            future.result()->children_count() != kExpectedCounts[i]) {
+          LogMessage("ERROR: Query cache returned unexpected results.");
+          failed = true;
+        }
+      }
+    }
+    // Equivalent specs must share an entry.
+    WaitForCompletion(
+        cache->GetValue(QuerySpec().OrderByKey().StartAt("Cranberry").EndAt(
+            "Cranberry")),
+        "QueryCacheEquivalentSpec");
+    QueryCacheStats stats = cache->stats();
+    if (stats.misses != kNumSpecs || stats.hits != kNumSpecs + 1) {
+      LogMessage(
+          "ERROR: Query cache got %d hits and %d misses, expected %d and %d.",
+          static_cast<int>(stats.hits), static_cast<int>(stats.misses),
+          static_cast<int>(kNumSpecs + 1), static_cast<int>(kNumSpecs));
+      failed = true;
+    }
+
+    // Changing a child must invalidate the cached results that hold it or
+    // that it moves into, which is every spec but the last.
+    WaitForCompletion(ref.Child("QueryFiltering").Child("Banana").SetValue(20),
+                      "QueryCacheSetValue");
+    ProcessEvents(1000);
+    if (cache->stats().invalidations != kNumSpecs - 1 || cache->size() != 1) {
+      LogMessage(
+          "ERROR: Query cache dropped %d results on a change, expected %d.",
+          static_cast<int>(cache->stats().invalidations),
+          static_cast<int>(kNumSpecs - 1));
+      failed = true;
+    }
+    auto refetched = cache->GetValue(QuerySpec().OrderByValue().LimitToLast(2));
+    WaitForCompletion(refetched, "QueryCacheRefetch");
+    if (refetched.error() != firebase::database::kErrorNone ||
+        !refetched.result()->HasChild("Banana") ||
+        cache->stats().misses != kNumSpecs + 1) {
+      LogMessage("ERROR: Query cache did not refetch changed data.");
+      failed = true;
+    }
+    WaitForCompletion(cache->GetValue(specs[kNumSpecs - 1]),
+                      "QueryCacheUnaffectedSpec");
+    if (cache->stats().misses != kNumSpecs + 1) {
+      LogMessage("ERROR: Query cache dropped a result the change didn't "
+                 "affect.");
+      failed = true;
+    }
+    stats = cache->stats();
+    LogMessage("  Query cache: %d hits, %d misses, %d invalidations.",
+               static_cast<int>(stats.hits), static_cast<int>(stats.misses),
+               static_cast<int>(stats.invalidations));
+    if (!failed) {
+      LogMessage("SUCCESS: Query cache served repeated queries locally.");
+    }
+    delete cache;
+    // Restore the original value for any later tests.
+    WaitForCompletion(ref.Child("QueryFiltering").Child("Banana").SetValue(2),
+                      "QueryCacheRestoreValue");
+  }
+
+  // Test LocalIndex, which answers queries on several orderings locally from
+  // one ChildListener.
+  {
+    LogMessage("TEST: Local index.");
+    firebase::database::DatabaseReference players = ref.Child("LocalIndex");
+    std::map<std::string, firebase::Variant> values;
+    for (int i = 0; i < 10; i++) {
+      std::map<std::string, firebase::Variant> stats;
+      stats["level"] = i % 4;
+      std::map<std::string, firebase::Variant> player;
+      player["score"] = i * 10;
+      player["stats"] = stats;
+      char key[16];
+      snprintf(key, sizeof(key), "player_%d", i);
+      values[key] = player;
+    }
+    WaitForCompletion(players.SetValue(values), "LocalIndexSetValues");
+
+    LocalIndex* index = new LocalIndex(players, {"score", "stats/level"});
+    // The index's listener reports the existing children when it's attached.
+    ProcessEvents(2000);
+
+    bool failed = false;
+    std::vector<std::string> keys;
+    auto start = std::chrono::steady_clock::now();
+    index->Top("score", 3, &keys);
+    double top_us = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    if (index->size() != 10 || keys.size() != 3 || keys[0] != "player_9" ||
+        keys[2] != "player_7") {
+      LogMessage("ERROR: Local index returned the wrong top scores.");
+      failed = true;
+    }
+    // Levels 2 and 3 are players 2, 3, 6 and 7.
+    start = std::chrono::steady_clock::now();
+    index->Range("stats/level", 2, 3, 0, &keys);
+    double range_us = std::chrono::duration<double, std::micro>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    if (keys.size() != 4 || keys[0] != "player_2" || keys[3] != "player_7") {
+      LogMessage("ERROR: Local index returned the wrong range of levels.");
+      failed = true;
+    }
+    LogMessage("  Local index: top 3 in %.1f us, range in %.1f us.", top_us,
+               range_us);
+
+    // Changes and removals must be reflected in every index.
+    WaitForCompletion(players.Child("player_0").Child("score").SetValue(1000),
+                      "LocalIndexSetScore");
+    WaitForCompletion(players.Child("player_9").RemoveValue(),
+                      "LocalIndexRemove");
+    ProcessEvents(1000);
+    index->Top("score", 1, &keys);
+    if (keys.size() != 1 || keys[0] != "player_0") {
+      LogMessage("ERROR: Local index missed a change.");
+      failed = true;
+    }
+    index->Range("stats/level", 1, 1, 0, &keys);
+    if (index->size() != 9 || keys.size() != 2) {
+      LogMessage("ERROR: Local index missed a removal.");
+      failed = true;
+    }
+    if (!index->Range("missing", 0, 1, 0, &keys)) {
+      LogMessage("  Querying a field without an index failed, as expected.");
+    } else {
+      LogMessage("ERROR: Local index queried a field without an index.");
+      failed = true;
+    }
+    if (!failed) {
+      LogMessage("SUCCESS: Local index answered queries locally.");
+    }
+    delete index;
+  }
+
+  // Test PaginatedReader, which walks the children of a location a page at a
+  // time rather than fetching them all at once.
+  {
+    LogMessage("TEST: Paginated reader.");
+    const int kNumChildren = 25;
+    const size_t kPageSize = 4;
+    std::map<std::string, int> children;
+    for (int i = 0; i < kNumChildren; i++) {
+      char key[16];
+      snprintf(key, sizeof(key), "child_%02d", i);
+      children.insert(std::make_pair(key, i));
+    }
+    WaitForCompletion(ref.Child("PaginatedReader").SetValue(children),
+                      "PaginatedReaderSetValues");
+
+    bool failed = false;
+    PaginatedReader reader(ref.Child("PaginatedReader"), kPageSize);
+    std::vector<firebase::database::DataSnapshot> page;
+    int expected = 0;
+    while (reader.NextPage(&page)) {
+      if (page.size() > kPageSize) {
+        LogMessage("ERROR: Paginated reader returned an oversized page.");
+        failed = true;
+      }
+      for (const auto& child : page) {
+        if (child.value().AsInt64().int64_value() != expected) {
+          LogMessage("ERROR: Paginated reader returned %s out of order.",
+                     child.key());
+          failed = true;
+        }
+        expected++;
+      }
+    }
+    if (reader.error() != firebase::database::kErrorNone) {
+      LogMessage("ERROR: Paginated reader failed with error %d: %s",
+                 reader.error(), reader.error_message().c_str());
+      failed = true;
+    }
+    if (reader.children_read() != kNumChildren ||
+        reader.pages_read() != (kNumChildren + kPageSize - 1) / kPageSize) {
+      LogMessage("ERROR: Paginated reader read %d children in %d pages.",
+                 static_cast<int>(reader.children_read()),
+                 static_cast<int>(reader.pages_read()));
+      failed = true;
+    }
+
+    // Stop part way through a walk.
+    int visited = 0;
+    ForEachChild(ref.Child("PaginatedReader"), kPageSize,
+                 [&visited](const firebase::database::DataSnapshot& child) {
+                   return ++visited < 10;
+                 });
+    if (visited != 10) {
+      LogMessage("ERROR: ForEachChild did not stop when asked to.");
+      failed = true;
+    }
+    if (!failed) {
+      LogMessage("SUCCESS: Paginated reader read all children in order.");
+    }
+  }
+
   // Test a ValueListener, which sits on a Query and listens for changes in
   // the value at that location.
   {
@@ -722,6 +1238,79 @@ extern "C" int common_main(int argc, const char* argv[]) {
 
     delete listener;
   }
+
+  // Test a DiffingValueListener, which passes on only the leaves that changed.
+  {
+    LogMessage("TEST: DiffingValueListener");
+    firebase::database::DatabaseReference diff_ref =
+        ref.Child("DiffingValueListener");
+    std::map<std::string, firebase::Variant> stats;
+    stats["hp"] = 100;
+    stats["mp"] = 50;
+    std::map<std::string, firebase::Variant> player;
+    player["name"] = "Tom";
+    player["stats"] = stats;
+    WaitForCompletion(diff_ref.SetValue(player), "SetPlayer");
+
+    std::vector<std::string> seen_changes;
+    DiffingValueListener* listener = new DiffingValueListener(
+        [&seen_changes](const std::vector<SnapshotChange>& changes) {
+          for (const SnapshotChange& change : changes) {
+            LogMessage("  DiffingValueListener: %d %s", change.type,
+                       change.path.c_str());
+            seen_changes.push_back(change.path);
+          }
+        });
+    diff_ref.AddValueListener(listener);
+    ProcessEvents(2000);
+    size_t initial_changes = seen_changes.size();
+
+    WaitForCompletion(diff_ref.Child("stats").Child("hp").SetValue(90),
+                      "SetHp");
+    ProcessEvents(2000);
+    diff_ref.RemoveValueListener(listener);
+
+    // The initial value reports every leaf as added, the update only the one
+    // leaf that changed.
+    if (initial_changes == 3 && seen_changes.size() == 4 &&
+        seen_changes.back() == "stats/hp") {
+      LogMessage("SUCCESS: DiffingValueListener reported only the change.");
+    } else {
+      LogMessage("ERROR: DiffingValueListener reported %d changes.",
+                 static_cast<int>(seen_changes.size()));
+    }
+
+    delete listener;
+  }
+
+  // Test a FlatSnapshot, a compact copy of a snapshot.
+  {
+    LogMessage("TEST: Flat snapshot.");
+    std::map<std::string, firebase::Variant> player;
+    player["name"] = "Tom";
+    player["score"] = 42;
+    player["items"] = std::vector<firebase::Variant>{"sword", "shield"};
+    WaitForCompletion(ref.Child("FlatSnapshot").Child("tom").SetValue(player),
+                      "SetFlatSnapshot");
+    firebase::Future<firebase::database::DataSnapshot> future =
+        ref.Child("FlatSnapshot").GetValue();
+    WaitForCompletion(future, "GetFlatSnapshot");
+    if (future.error() == firebase::database::kErrorNone) {
+      FlatSnapshot flat(*future.result());
+      FlatSnapshot::Node tom = flat.root().Child("tom");
+      if (tom.Child("score").int64_value() == 42 &&
+          strcmp(tom.Child("name").string_value(), "Tom") == 0 &&
+          strcmp(tom.Child("items").Child("1").string_value(), "shield") ==
+              0 &&
+          !tom.Child("missing").is_valid() &&
+          flat.root().ToVariant() == future.result()->value()) {
+        LogMessage("SUCCESS: Flat snapshot matches the DataSnapshot.");
+      } else {
+        LogMessage("ERROR: Flat snapshot doesn't match the DataSnapshot.");
+      }
+    }
+  }
+
   // Test a ChildListener, which sits on a Query and listens for changes in
   // the child hierarchy at the location.
   {
@@ -864,6 +1453,71 @@ extern "C" int common_main(int argc, const char* argv[]) {
     delete listener;
   }
 
+  // Test the prefetch planner: a prefetched location is read as a hit, and a
+  // location bigger than the budget is evicted once its size is known.
+  {
+    LogMessage("TEST: Prefetch planner.");
+    WaitForCompletion(ref.Child("Prefetch").SetValue("Some prefetched data"),
+                      "PrefetchSetValue");
+    PrefetchPlanner planner(1024);
+    planner.Prefetch(ref.Child("Prefetch"));
+    for (int i = 0; i < 100 && planner.warming(); i++) {
+      planner.Poll();
+      ProcessEvents(100);
+    }
+    WaitForCompletion(planner.GetValue(ref.Child("Prefetch")),
+                      "PrefetchGetValue");
+    PrefetchPlanner small_planner(4);
+    small_planner.Prefetch(ref.Child("Prefetch"));
+    for (int i = 0; i < 100 && small_planner.warming(); i++) {
+      small_planner.Poll();
+      ProcessEvents(100);
+    }
+    if (planner.stats().hits != 1 || planner.stats().misses != 0) {
+      LogMessage("ERROR: Prefetched read was not a hit.");
+    } else if (small_planner.stats().evictions != 1 ||
+               small_planner.size() != 0) {
+      LogMessage("ERROR: Prefetch over budget was not evicted.");
+    } else {
+      LogMessage("SUCCESS: Prefetch planner test passed.");
+    }
+  }
+
+  // Test presence: the connection node is written once the client is
+  // connected, and removed again when presence is stopped.
+  {
+    LogMessage("TEST: Presence.");
+    Presence presence(ref.Child("Presence"), "test_user");
+    presence.Start();
+    for (int i = 0; i < 100 && !presence.online() &&
+                    presence.error() == firebase::database::kErrorNone;
+         i++) {
+      presence.Poll();
+      ProcessEvents(100);
+    }
+    bool online = presence.online();
+    firebase::Future<firebase::database::DataSnapshot> online_future =
+        ref.Child("Presence").Child("test_user").GetValue();
+    WaitForCompletion(online_future, "PresenceOnline");
+    WaitForCompletion(presence.Stop(), "PresenceStop");
+    firebase::Future<firebase::database::DataSnapshot> offline_future =
+        ref.Child("Presence").Child("test_user").GetValue();
+    WaitForCompletion(offline_future, "PresenceOffline");
+    if (presence.error() != firebase::database::kErrorNone) {
+      LogMessage("ERROR: Presence failed with error %d.", presence.error());
+    } else if (!online) {
+      LogMessage("ERROR: Presence did not come online.");
+    } else if (online_future.error() != firebase::database::kErrorNone ||
+               online_future.result()->children_count() != 1 ||
+               offline_future.error() != firebase::database::kErrorNone ||
+               offline_future.result()->exists()) {
+      LogMessage("ERROR: Presence connection node was incorrect.");
+    } else {
+      LogMessage("SUCCESS: Presence registered in %.1f ms.",
+                 presence.registration_seconds() * 1000.0);
+    }
+  }
+
   // Now check OnDisconnect. When you set an OnDisconnect handler for a
   // database location, an operation will be performed on that location when
   // you disconnect from Firebase Database. In this sample app, we replicate
@@ -0,0 +1,206 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"       // NOLINT
+#include "firebase/app.h"
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "sharded_counter.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct CounterResult {
+  CounterResult() : commits(0), failures(0), attempts(0), seconds(0) {}
+
+  int64_t commits;
+  int64_t failures;
+  int64_t attempts;
+  double seconds;
+};
+
+// Waits for future from a worker thread. Nothing calls ProcessEvents() while
+// the workers run, as the main thread is blocked joining them, so this only
+// polls the future, which the SDK completes on its own threads.
+void WaitOnThread(const firebase::FutureBase& future) {
+  while (future.status() == firebase::kFutureStatusPending) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+// A simulated client with its own App and Database, and so its own
+// connection. A single client runs the transactions on a node one at a time,
+// so concurrent increments from one Database would never contend at the
+// server.
+struct CounterClient {
+  CounterClient() : app(nullptr), database(nullptr), counter(nullptr) {}
+
+  firebase::App* app;
+  firebase::database::Database* database;
+  ShardedCounter* counter;
+};
+
+// Increments the counter at path from num_threads clients at once, each on
+// its own thread, increments times each, then checks that the counter adds
+// up.
+bool RunCounter(firebase::database::Database* database,
+                const std::string& path, int num_shards, int num_threads,
+                int increments, CounterResult* result) {
+  std::vector<CounterClient> clients(num_threads);
+  bool success = true;
+  for (int i = 0; i < num_threads; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "counter_client_%d", i);
+    CounterClient& client = clients[i];
+#if defined(__ANDROID__)
+    client.app = firebase::App::Create(database->app()->options(), name,
+                                       GetJniEnv(), GetActivity());
+#else
+    client.app = firebase::App::Create(database->app()->options(), name);
+#endif  // defined(__ANDROID__)
+    client.database =
+        firebase::database::Database::GetInstance(client.app, database->url());
+    if (!client.database) {
+      LogMessage("ERROR: Unable to create database client %d.", i);
+      success = false;
+      break;
+    }
+    client.database->set_persistence_enabled(false);
+    client.counter = new ShardedCounter(
+        client.database->GetReference(path.c_str()), num_shards);
+  }
+
+  std::atomic<int64_t> commits(0);
+  std::atomic<int64_t> failures(0);
+  Clock::time_point start = Clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads && success; i++) {
+    ShardedCounter* counter = clients[i].counter;
+    threads.push_back(std::thread([&, counter]() {
+      for (int j = 0; j < increments; j++) {
+        firebase::Future<firebase::database::DataSnapshot> future =
+            counter->Increment(1);
+        WaitOnThread(future);
+        if (future.status() == firebase::kFutureStatusComplete &&
+            future.error() == firebase::database::kErrorNone) {
+          commits++;
+        } else {
+          failures++;
+        }
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+  result->seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  result->commits = commits;
+  result->failures = failures;
+  result->attempts = 0;
+  for (auto& client : clients) {
+    if (client.counter) result->attempts += client.counter->attempts();
+    delete client.counter;
+    delete client.database;
+    delete client.app;
+  }
+  if (!success) return false;
+
+  ShardedCounter counter(database->GetReference(path.c_str()), num_shards);
+  firebase::Future<firebase::database::DataSnapshot> read = counter.Read();
+  while (read.status() == firebase::kFutureStatusPending) ProcessEvents(10);
+  if (read.error() != firebase::database::kErrorNone) {
+    LogMessage("ERROR: Reading the counter failed with error %d: %s",
+               read.error(), read.error_message());
+    return false;
+  }
+  int64_t total = ShardedCounter::Sum(*read.result());
+  if (total != result->commits) {
+    LogMessage("ERROR: The counter is %lld after %lld committed increments.",
+               static_cast<long long>(total),  // NOLINT
+               static_cast<long long>(result->commits));  // NOLINT
+    return false;
+  }
+  return true;
+}
+
+void LogResult(const char* name, int num_shards, const CounterResult& result) {
+  int64_t finished = result.commits + result.failures;
+  int64_t retries = result.attempts - finished;
+  LogMessage(
+      "  %s (%d shards): %lld commits in %.2f s (%.1f commits/s), %lld "
+      "failed, %lld retries (%.2f per commit).",
+      name, num_shards, static_cast<long long>(result.commits),  // NOLINT
+      result.seconds, result.seconds > 0 ? result.commits / result.seconds : 0,
+      static_cast<long long>(result.failures),  // NOLINT
+      static_cast<long long>(retries),          // NOLINT
+      result.commits ? static_cast<double>(retries) / result.commits : 0);
+}
+
+}  // namespace
+
+bool RunCounterBenchmark(firebase::database::Database* database, int argc,
+                         const char* argv[]) {
+  int num_threads = 8;
+  int increments = 25;
+  int num_shards = 16;
+  const char* threads_arg = GetArgument(argc, argv, "benchmark_threads");
+  if (threads_arg) num_threads = atoi(threads_arg);
+  const char* increments_arg = GetArgument(argc, argv, "benchmark_increments");
+  if (increments_arg) increments = atoi(increments_arg);
+  const char* shards_arg = GetArgument(argc, argv, "benchmark_shards");
+  if (shards_arg) num_shards = atoi(shards_arg);
+  if (num_threads <= 0 || increments <= 0 || num_shards <= 0) {
+    LogMessage("ERROR: --benchmark_threads, --benchmark_increments and "
+               "--benchmark_shards must be positive.");
+    return false;
+  }
+  LogMessage("Benchmarking counters with %d clients, %d increments each.",
+             num_threads, increments);
+
+  firebase::database::DatabaseReference location =
+      database->GetReference("benchmarks").PushChild();
+  std::string path = "benchmarks/" + location.key_string();
+  bool success = true;
+  {
+    CounterResult result;
+    success = RunCounter(database, path + "/single", 1, num_threads,
+                         increments, &result) &&
+              success;
+    LogResult("Single node", 1, result);
+  }
+  {
+    CounterResult result;
+    success = RunCounter(database, path + "/sharded", num_shards, num_threads,
+                         increments, &result) &&
+              success;
+    LogResult("Sharded", num_shards, result);
+  }
+
+  firebase::Future<void> cleanup = location.RemoveValue();
+  while (cleanup.status() == firebase::kFutureStatusPending) ProcessEvents(10);
+  LogMessage(success ? "SUCCESS: Counter benchmark complete."
+                     : "ERROR: Counter benchmark failed.");
+  return success;
+}
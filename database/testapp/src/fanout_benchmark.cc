@@ -0,0 +1,107 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"     // NOLINT
+#include "fanout_writer.h"  // NOLINT
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "firebase/variant.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+const int kPollMs = 1;
+
+// Waits for future, returning false if it failed.
+bool Wait(const firebase::FutureBase& future) {
+  while (future.status() == firebase::kFutureStatusPending) {
+    ProcessEvents(kPollMs);
+  }
+  return future.status() == firebase::kFutureStatusComplete &&
+         future.error() == firebase::database::kErrorNone;
+}
+
+}  // namespace
+
+bool RunFanoutBenchmark(firebase::database::Database* database, int argc,
+                        const char* argv[]) {
+  int max_paths = 10000;
+  int payload_bytes = 256;
+  FanoutOptions options;
+  const char* paths_arg = GetArgument(argc, argv, "benchmark_max_paths");
+  if (paths_arg) max_paths = atoi(paths_arg);
+  const char* payload_arg = GetArgument(argc, argv, "benchmark_payload_bytes");
+  if (payload_arg) payload_bytes = atoi(payload_arg);
+  const char* chunk_arg = GetArgument(argc, argv, "benchmark_chunk_bytes");
+  if (chunk_arg) options.chunk_bytes = strtoul(chunk_arg, nullptr, 10);
+  if (max_paths <= 0 || payload_bytes < 0) {
+    LogMessage("ERROR: --benchmark_max_paths must be positive and "
+               "--benchmark_payload_bytes not negative.");
+    return false;
+  }
+  LogMessage("Benchmarking fan-out writes of up to %d paths, %d byte "
+             "payloads, %d byte chunks.",
+             max_paths, payload_bytes, static_cast<int>(options.chunk_bytes));
+
+  firebase::database::DatabaseReference location =
+      database->GetReference("benchmarks").PushChild();
+  std::map<std::string, firebase::Variant> post;
+  post["author"] = "benchmark";
+  post["text"] = std::string(payload_bytes, 'x');
+  post["timestamp"] = firebase::database::ServerTimestamp();
+
+  bool success = true;
+  for (int fanout = 10; fanout <= max_paths; fanout *= 10) {
+    // Deliver a new post to the feed of each of fanout followers.
+    char post_key[32];
+    snprintf(post_key, sizeof(post_key), "post_%d", fanout);
+    std::vector<std::string> paths;
+    paths.reserve(fanout);
+    for (int i = 0; i < fanout; i++) {
+      char path[64];
+      snprintf(path, sizeof(path), "feeds/user_%05d/%s", i, post_key);
+      paths.push_back(path);
+    }
+
+    FanoutResult result;
+    success = WriteFanout(location, paths, post, options, &result) && success;
+    std::vector<double> latencies;
+    for (const FanoutChunk& chunk : result.chunks) {
+      latencies.push_back(chunk.seconds);
+    }
+    LogMessage(
+        "  %d paths: %d chunk(s), %.2f MB, %.1f ms total, %.1f ms "
+        "inconsistent, %.0f paths/s.",
+        fanout, static_cast<int>(result.chunks.size()),
+        result.bytes() / (1024.0 * 1024.0), result.seconds * 1000.0,
+        result.inconsistent_seconds * 1000.0,
+        result.seconds > 0 ? fanout / result.seconds : 0);
+    char name[32];
+    snprintf(name, sizeof(name), "Chunks of %d paths", fanout);
+    LogLatencies(name, latencies);
+  }
+
+  success = Wait(location.RemoveValue()) && success;
+  LogMessage(success ? "SUCCESS: Fan-out benchmark complete."
+                     : "ERROR: Fan-out benchmark failed.");
+  return success;
+}
@@ -0,0 +1,141 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fanout_writer.h"  // NOLINT
+
+#include <chrono>
+#include <map>
+#include <unordered_set>
+
+#include "firebase/future.h"
+#include "variant_json.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kPollMs = 1;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Returns false, logging why, if a path is repeated or is an ancestor of
+// another.
+bool ValidatePaths(const std::vector<std::string>& paths) {
+  std::unordered_set<std::string> seen(paths.begin(), paths.end());
+  if (seen.size() != paths.size()) {
+    LogMessage("ERROR: Fan-out paths must not be repeated.");
+    return false;
+  }
+  for (const std::string& path : paths) {
+    for (size_t slash = path.find('/'); slash != std::string::npos;
+         slash = path.find('/', slash + 1)) {
+      if (seen.count(path.substr(0, slash))) {
+        LogMessage("ERROR: Fan-out path %s is inside another path.",
+                   path.c_str());
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool FanoutResult::succeeded() const {
+  for (const FanoutChunk& chunk : chunks) {
+    if (chunk.error != firebase::database::kErrorNone) return false;
+  }
+  return true;
+}
+
+size_t FanoutResult::bytes() const {
+  size_t total = 0;
+  for (const FanoutChunk& chunk : chunks) total += chunk.bytes;
+  return total;
+}
+
+bool WriteFanout(const firebase::database::DatabaseReference& root,
+                 const std::vector<std::string>& paths,
+                 const firebase::Variant& payload,
+                 const FanoutOptions& options, FanoutResult* result) {
+  *result = FanoutResult();
+  if (paths.empty()) return true;
+  if (!ValidatePaths(paths)) return false;
+
+  // Each member of an update costs the payload, its quoted path, a colon and
+  // a comma.
+  size_t payload_bytes = VariantToJson(payload).size();
+  std::vector<firebase::Future<void>> futures;
+  std::vector<Clock::time_point> issued;
+  std::map<std::string, firebase::Variant> update;
+  FanoutChunk chunk;
+  chunk.bytes = 2;  // The braces.
+  firebase::database::DatabaseReference location = root;
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < paths.size(); i++) {
+    update[paths[i]] = payload;
+    chunk.paths++;
+    chunk.bytes += paths[i].size() + payload_bytes + 4;
+    bool last = i + 1 == paths.size();
+    if (last || (options.chunk_bytes &&
+                 chunk.bytes + paths[i + 1].size() + payload_bytes + 4 >
+                     options.chunk_bytes)) {
+      issued.push_back(Clock::now());
+      futures.push_back(location.UpdateChildren(update));
+      result->chunks.push_back(chunk);
+      update.clear();
+      chunk = FanoutChunk();
+      chunk.first_path = i + 1;
+      chunk.bytes = 2;
+    }
+  }
+
+  // Record when each chunk completes.
+  std::vector<bool> completed(futures.size(), false);
+  size_t pending = futures.size();
+  double first_completed = -1;
+  while (pending) {
+    for (size_t i = 0; i < futures.size(); i++) {
+      if (completed[i] ||
+          futures[i].status() == firebase::kFutureStatusPending) {
+        continue;
+      }
+      FanoutChunk& done = result->chunks[i];
+      done.seconds = SecondsSince(issued[i]);
+      done.error = futures[i].status() == firebase::kFutureStatusComplete
+                       ? static_cast<firebase::database::Error>(
+                             futures[i].error())
+                       : firebase::database::kErrorUnknownError;
+      if (first_completed < 0) first_completed = SecondsSince(start);
+      completed[i] = true;
+      pending--;
+    }
+    if (pending) ProcessEvents(kPollMs);
+  }
+  result->seconds = SecondsSince(start);
+  result->inconsistent_seconds = result->seconds - first_completed;
+  if (result->atomic()) result->inconsistent_seconds = 0;
+
+  if (!result->succeeded()) {
+    LogMessage("ERROR: Fan-out to %d paths was only partially written.",
+               static_cast<int>(paths.size()));
+    return false;
+  }
+  return true;
+}
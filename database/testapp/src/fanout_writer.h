@@ -0,0 +1,86 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_FANOUT_WRITER_H_  // NOLINT
+#define FIREBASE_TESTAPP_FANOUT_WRITER_H_  // NOLINT
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "firebase/database.h"
+#include "firebase/variant.h"
+
+struct FanoutOptions {
+  FanoutOptions() : chunk_bytes(256 * 1024) {}
+
+  // Largest UpdateChildren() call to make, in bytes of JSON. A fan-out that
+  // fits is written atomically in one call; a larger one is split into calls
+  // of about this size, each atomic on its own. 0 never splits.
+  size_t chunk_bytes;
+};
+
+// One UpdateChildren() call of a fan-out.
+struct FanoutChunk {
+  FanoutChunk()
+      : first_path(0),
+        paths(0),
+        bytes(0),
+        seconds(0),
+        error(firebase::database::kErrorNone) {}
+
+  // The chunk wrote paths[first_path] up to paths[first_path + paths - 1].
+  size_t first_path;
+  size_t paths;
+  // Bytes of JSON in the update.
+  size_t bytes;
+  // Time from issuing the update until it completed.
+  double seconds;
+  // kErrorNone if the chunk was written.
+  firebase::database::Error error;
+};
+
+struct FanoutResult {
+  FanoutResult() : seconds(0), inconsistent_seconds(0) {}
+
+  // Returns whether every chunk was written.
+  bool succeeded() const;
+  // Returns whether the whole fan-out was a single atomic update.
+  bool atomic() const { return chunks.size() <= 1; }
+  size_t bytes() const;
+
+  std::vector<FanoutChunk> chunks;
+  // Time from issuing the first chunk until the last one completed.
+  double seconds;
+  // Time between the first and the last chunk completing, during which
+  // readers could see some of the copies updated and others not. Always 0
+  // for an atomic fan-out.
+  double inconsistent_seconds;
+};
+
+// Writes a copy of payload to each of paths under root, e.g. a new post to
+// the feed of each follower, with as few UpdateChildren() calls as
+// options.chunk_bytes allows. The chunks are issued together and waited for,
+// and each one's size and latency is recorded in result.
+//
+// Returns false if the paths are invalid (one is a duplicate or an ancestor
+// of another, which UpdateChildren() rejects) or if any chunk failed. The
+// paths of a chunk which failed can be found from its first_path and paths,
+// and written again.
+bool WriteFanout(const firebase::database::DatabaseReference& root,
+                 const std::vector<std::string>& paths,
+                 const firebase::Variant& payload,
+                 const FanoutOptions& options, FanoutResult* result);
+
+#endif  // FIREBASE_TESTAPP_FANOUT_WRITER_H_  // NOLINT
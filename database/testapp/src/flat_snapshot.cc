@@ -0,0 +1,265 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "flat_snapshot.h"  // NOLINT
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Lays out a Variant in a FlatSnapshot's buffer in a single walk. The entries
+// for a container's children are reserved together before any of them are
+// filled in, which keeps them contiguous.
+class FlatSnapshot::Builder {
+ public:
+  explicit Builder(FlatSnapshot* snapshot) : snapshot_(snapshot) {}
+
+  void Build(const firebase::Variant& value) {
+    snapshot_->buffer_.assign(sizeof(Entry), 0);
+    snapshot_->node_count_ = 1;
+    empty_key_ = Intern(std::string());
+    Fill(0, empty_key_, 0, value);
+  }
+
+ private:
+  // Appends data and a terminating '\0' to the buffer, returns its offset.
+  uint32_t Append(const char* data, size_t size) {
+    std::vector<char>& buffer = snapshot_->buffer_;
+    uint32_t offset = static_cast<uint32_t>(buffer.size());
+    buffer.insert(buffer.end(), data, data + size);
+    buffer.push_back('\0');
+    return offset;
+  }
+
+  uint32_t Intern(const std::string& key) {
+    auto it = keys_.find(key);
+    if (it != keys_.end()) return it->second;
+    uint32_t offset = Append(key.data(), key.size());
+    keys_[key] = offset;
+    return offset;
+  }
+
+  void Fill(uint32_t offset, uint32_t key_offset, size_t key_size,
+            const firebase::Variant& value) {
+    Entry entry = Entry();
+    entry.key_offset = key_offset;
+    entry.key_size = static_cast<uint16_t>(key_size);
+    entry.type = kTypeNull;
+    switch (value.type()) {
+      case firebase::Variant::kTypeInt64: {
+        int64_t i = value.int64_value();
+        entry.type = kTypeInt64;
+        memcpy(&entry.payload, &i, sizeof(i));
+        break;
+      }
+      case firebase::Variant::kTypeDouble: {
+        double d = value.double_value();
+        entry.type = kTypeDouble;
+        memcpy(&entry.payload, &d, sizeof(d));
+        break;
+      }
+      case firebase::Variant::kTypeBool:
+        entry.type = kTypeBool;
+        entry.payload = value.bool_value() ? 1 : 0;
+        break;
+      case firebase::Variant::kTypeStaticString:
+      case firebase::Variant::kTypeMutableString: {
+        const char* s = value.string_value();
+        size_t size = strlen(s);
+        entry.type = kTypeString;
+        entry.payload = static_cast<uint64_t>(Append(s, size)) << 32 | size;
+        break;
+      }
+      case firebase::Variant::kTypeMap:
+      case firebase::Variant::kTypeVector:
+        FillContainer(value, &entry);
+        break;
+      default:
+        break;
+    }
+    memcpy(&snapshot_->buffer_[offset], &entry, sizeof(entry));
+  }
+
+  void FillContainer(const firebase::Variant& value, Entry* entry) {
+    // Gather the children in the scratch list shared by every level. Indices
+    // from base stay valid while deeper levels push and pop past them.
+    size_t base = children_.size();
+    if (value.is_map()) {
+      for (auto& child : value.map()) {
+        children_.push_back(std::make_pair(
+            child.first.is_string() ? std::string(child.first.string_value())
+                                    : child.first.AsString().string_value(),
+            &child.second));
+      }
+      std::sort(children_.begin() + base, children_.end());
+    } else {
+      for (const firebase::Variant& child : value.vector()) {
+        children_.push_back(std::make_pair(std::string(), &child));
+      }
+    }
+    size_t count = children_.size() - base;
+    if (count == 0) return;  // Empty containers don't exist in the database.
+
+    std::vector<char>& buffer = snapshot_->buffer_;
+    uint32_t first = static_cast<uint32_t>(buffer.size());
+    buffer.resize(buffer.size() + count * sizeof(Entry));
+    snapshot_->node_count_ += count;
+    for (size_t i = 0; i < count; i++) {
+      const std::string& key = children_[base + i].first;
+      uint32_t key_offset = key.empty() ? empty_key_ : Intern(key);
+      Fill(static_cast<uint32_t>(first + i * sizeof(Entry)), key_offset,
+           key.size(), *children_[base + i].second);
+    }
+    children_.resize(base);
+
+    entry->type = value.is_map() ? kTypeMap : kTypeVector;
+    entry->payload = static_cast<uint64_t>(first) << 32 | count;
+  }
+
+  FlatSnapshot* snapshot_;
+  std::unordered_map<std::string, uint32_t> keys_;
+  uint32_t empty_key_;
+  std::vector<std::pair<std::string, const firebase::Variant*>> children_;
+};
+
+FlatSnapshot::FlatSnapshot() : FlatSnapshot(firebase::Variant::Null()) {}
+
+FlatSnapshot::FlatSnapshot(const firebase::Variant& value) : node_count_(0) {
+  Builder(this).Build(value);
+}
+
+FlatSnapshot::FlatSnapshot(const firebase::database::DataSnapshot& snapshot)
+    : FlatSnapshot(snapshot.value()) {}
+
+FlatSnapshot::Entry FlatSnapshot::GetEntry(uint32_t offset) const {
+  Entry entry;
+  memcpy(&entry, &buffer_[offset], sizeof(entry));
+  return entry;
+}
+
+FlatSnapshot::Type FlatSnapshot::Node::type() const {
+  if (!snapshot_) return kTypeNull;
+  return static_cast<Type>(snapshot_->GetEntry(offset_).type);
+}
+
+const char* FlatSnapshot::Node::key() const {
+  if (!snapshot_) return "";
+  return &snapshot_->buffer_[snapshot_->GetEntry(offset_).key_offset];
+}
+
+size_t FlatSnapshot::Node::key_size() const {
+  return snapshot_ ? snapshot_->GetEntry(offset_).key_size : 0;
+}
+
+int64_t FlatSnapshot::Node::int64_value() const {
+  if (!is_int64()) return 0;
+  uint64_t payload = snapshot_->GetEntry(offset_).payload;
+  int64_t value;
+  memcpy(&value, &payload, sizeof(value));
+  return value;
+}
+
+double FlatSnapshot::Node::double_value() const {
+  if (!is_double()) return 0;
+  uint64_t payload = snapshot_->GetEntry(offset_).payload;
+  double value;
+  memcpy(&value, &payload, sizeof(value));
+  return value;
+}
+
+bool FlatSnapshot::Node::bool_value() const {
+  return is_bool() && snapshot_->GetEntry(offset_).payload != 0;
+}
+
+const char* FlatSnapshot::Node::string_value() const {
+  if (!is_string()) return "";
+  uint64_t payload = snapshot_->GetEntry(offset_).payload;
+  return &snapshot_->buffer_[static_cast<uint32_t>(payload >> 32)];
+}
+
+size_t FlatSnapshot::Node::string_size() const {
+  if (!is_string()) return 0;
+  return static_cast<uint32_t>(snapshot_->GetEntry(offset_).payload);
+}
+
+size_t FlatSnapshot::Node::children_count() const {
+  if (!is_map() && !is_vector()) return 0;
+  return static_cast<uint32_t>(snapshot_->GetEntry(offset_).payload);
+}
+
+FlatSnapshot::Node FlatSnapshot::Node::child(size_t index) const {
+  if (index >= children_count()) return Node();
+  uint32_t first =
+      static_cast<uint32_t>(snapshot_->GetEntry(offset_).payload >> 32);
+  return Node(snapshot_,
+              static_cast<uint32_t>(first + index * sizeof(Entry)));
+}
+
+FlatSnapshot::Node FlatSnapshot::Node::Child(const char* key) const {
+  if (is_vector()) {
+    char* end;
+    unsigned long index = strtoul(key, &end, 10);  // NOLINT
+    if (end == key || *end != '\0') return Node();
+    return child(index);
+  }
+  size_t low = 0;
+  size_t high = children_count();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    Node candidate = child(middle);
+    int order = strcmp(candidate.key(), key);
+    if (order == 0) return candidate;
+    if (order < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return Node();
+}
+
+firebase::Variant FlatSnapshot::Node::ToVariant() const {
+  switch (type()) {
+    case kTypeInt64:
+      return firebase::Variant(int64_value());
+    case kTypeDouble:
+      return firebase::Variant(double_value());
+    case kTypeBool:
+      return firebase::Variant(bool_value());
+    case kTypeString:
+      return firebase::Variant(std::string(string_value(), string_size()));
+    case kTypeMap: {
+      firebase::Variant map = firebase::Variant::EmptyMap();
+      for (size_t i = 0; i < children_count(); i++) {
+        Node node = child(i);
+        map.map()[firebase::Variant(std::string(node.key(), node.key_size()))] =
+            node.ToVariant();
+      }
+      return map;
+    }
+    case kTypeVector: {
+      firebase::Variant vector = firebase::Variant::EmptyVector();
+      vector.vector().reserve(children_count());
+      for (size_t i = 0; i < children_count(); i++) {
+        vector.vector().push_back(child(i).ToVariant());
+      }
+      return vector;
+    }
+    default:
+      return firebase::Variant::Null();
+  }
+}
@@ -0,0 +1,139 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_FLAT_SNAPSHOT_H_  // NOLINT
+#define FIREBASE_TESTAPP_FLAT_SNAPSHOT_H_  // NOLINT
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "firebase/database.h"
+#include "firebase/variant.h"
+
+// An immutable copy of a snapshot in a single contiguous buffer, for listeners
+// that keep the values they receive.
+//
+// A Variant holds every map, vector and string in its own heap allocations,
+// with each map key stored again in every record that uses it. A FlatSnapshot
+// holds the whole tree in one buffer: each node is a fixed size entry, the
+// children of a map or vector are contiguous entries sorted by key, pointers
+// are replaced with offsets into the buffer, and each distinct key is stored
+// once. It is built in a single walk of the value, and read through Nodes that
+// never allocate:
+//
+//   FlatSnapshot players(snapshot);
+//   FlatSnapshot::Node tom = players.root().Child("tom");
+//   if (tom.Child("score").is_int64()) ...
+//
+// The buffer is limited to 4GB. Blobs, which the database doesn't store, are
+// read back as null.
+class FlatSnapshot {
+ public:
+  enum Type {
+    kTypeNull,
+    kTypeInt64,
+    kTypeDouble,
+    kTypeBool,
+    kTypeString,
+    kTypeMap,
+    kTypeVector,
+  };
+
+  // A node of a FlatSnapshot, valid for as long as the snapshot is.
+  class Node {
+   public:
+    // A missing node, which reads as null.
+    Node() : snapshot_(nullptr), offset_(0) {}
+
+    // Returns false for the result of looking up a missing child.
+    bool is_valid() const { return snapshot_ != nullptr; }
+
+    Type type() const;
+    bool is_null() const { return type() == kTypeNull; }
+    bool is_int64() const { return type() == kTypeInt64; }
+    bool is_double() const { return type() == kTypeDouble; }
+    bool is_bool() const { return type() == kTypeBool; }
+    bool is_string() const { return type() == kTypeString; }
+    bool is_map() const { return type() == kTypeMap; }
+    bool is_vector() const { return type() == kTypeVector; }
+
+    // This node's key in its parent map, or "" for the root and elements of
+    // vectors.
+    const char* key() const;
+    size_t key_size() const;
+
+    // The value, or 0, false or "" if the node is of another type.
+    int64_t int64_value() const;
+    double double_value() const;
+    bool bool_value() const;
+    const char* string_value() const;
+    size_t string_size() const;
+
+    // Children of a map, sorted by key, or elements of a vector.
+    size_t children_count() const;
+    Node child(size_t index) const;
+    // Looks up a child of a map by key, with a binary search, or an element of
+    // a vector by its index. Returns an invalid Node if there isn't one.
+    Node Child(const char* key) const;
+
+    // Copies the node back into a Variant.
+    firebase::Variant ToVariant() const;
+
+   private:
+    friend class FlatSnapshot;
+
+    Node(const FlatSnapshot* snapshot, uint32_t offset)
+        : snapshot_(snapshot), offset_(offset) {}
+
+    const FlatSnapshot* snapshot_;
+    // Offset of the node's entry in the snapshot's buffer.
+    uint32_t offset_;
+  };
+
+  // An empty snapshot, whose root is null.
+  FlatSnapshot();
+  explicit FlatSnapshot(const firebase::Variant& value);
+  explicit FlatSnapshot(const firebase::database::DataSnapshot& snapshot);
+
+  Node root() const { return Node(this, 0); }
+
+  // Size of the buffer, which is all the memory the snapshot holds.
+  size_t size_bytes() const { return buffer_.size(); }
+  // Number of nodes, including the root.
+  size_t node_count() const { return node_count_; }
+
+ private:
+  // The fixed size entry of a node. Entries are copied in and out of the
+  // buffer, so they need no alignment.
+  struct Entry {
+    // The key, stored once in the buffer with a terminating '\0'.
+    uint32_t key_offset;
+    uint16_t key_size;
+    uint8_t type;
+    // Int64, double or bool value, or for strings the offset and size of the
+    // characters, and for maps and vectors the offset of the first child and
+    // the number of children.
+    uint64_t payload;
+  };
+
+  class Builder;
+
+  Entry GetEntry(uint32_t offset) const;
+
+  std::vector<char> buffer_;
+  size_t node_count_;
+};
+
+#endif  // FIREBASE_TESTAPP_FLAT_SNAPSHOT_H_  // NOLINT
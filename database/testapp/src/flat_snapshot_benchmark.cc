@@ -0,0 +1,219 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "benchmarks.h"     // NOLINT
+#include "firebase/variant.h"
+#include "flat_snapshot.h"  // NOLINT
+#include "process_stats.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double Megabytes(double bytes) { return bytes / (1024.0 * 1024.0); }
+
+// What a traversal saw: the number of nodes, and a checksum of the numbers
+// and string lengths, so that the walk can't be optimized away and both
+// representations can be checked to agree.
+struct Totals {
+  int64_t nodes;
+  double checksum;
+};
+
+void Walk(const firebase::Variant& value, Totals* totals) {
+  totals->nodes++;
+  if (value.is_map()) {
+    for (auto& entry : value.map()) Walk(entry.second, totals);
+  } else if (value.is_vector()) {
+    for (const firebase::Variant& element : value.vector()) {
+      Walk(element, totals);
+    }
+  } else if (value.is_int64()) {
+    totals->checksum += value.int64_value();
+  } else if (value.is_double()) {
+    totals->checksum += value.double_value();
+  } else if (value.is_bool()) {
+    totals->checksum += value.bool_value() ? 1 : 0;
+  } else if (value.is_string()) {
+    totals->checksum += strlen(value.string_value());
+  }
+}
+
+void Walk(const FlatSnapshot::Node& node, Totals* totals) {
+  totals->nodes++;
+  switch (node.type()) {
+    case FlatSnapshot::kTypeMap:
+    case FlatSnapshot::kTypeVector:
+      for (size_t i = 0; i < node.children_count(); i++) {
+        Walk(node.child(i), totals);
+      }
+      break;
+    case FlatSnapshot::kTypeInt64:
+      totals->checksum += node.int64_value();
+      break;
+    case FlatSnapshot::kTypeDouble:
+      totals->checksum += node.double_value();
+      break;
+    case FlatSnapshot::kTypeBool:
+      totals->checksum += node.bool_value() ? 1 : 0;
+      break;
+    case FlatSnapshot::kTypeString:
+      totals->checksum += node.string_size();
+      break;
+    default:
+      break;
+  }
+}
+
+// Logs the growth of resident memory between two measurements, per copy, if
+// it could be measured.
+void LogMemory(const char* label, int64_t before, int64_t after, int copies) {
+  if (before < 0 || after < 0) {
+    LogMessage("  %s: memory use unknown.", label);
+    return;
+  }
+  LogMessage("  %s: %+.2f MB resident, %.1f KB per copy.", label,
+             Megabytes(static_cast<double>(after - before)),
+             (after - before) / 1024.0 / copies);
+}
+
+}  // namespace
+
+bool RunFlatSnapshotBenchmark(firebase::database::Database* /*database*/,
+                              int argc, const char* argv[]) {
+  int records = 2000;
+  int copies = 20;
+  int iterations = 5;
+  const char* records_arg = GetArgument(argc, argv, "benchmark_records");
+  if (records_arg) records = atoi(records_arg);
+  const char* copies_arg = GetArgument(argc, argv, "benchmark_copies");
+  if (copies_arg) copies = atoi(copies_arg);
+  const char* iterations_arg = GetArgument(argc, argv, "benchmark_iterations");
+  if (iterations_arg) iterations = atoi(iterations_arg);
+  if (records <= 0 || copies <= 0 || iterations <= 0) {
+    LogMessage("ERROR: --benchmark_records, --benchmark_copies and "
+               "--benchmark_iterations must be positive.");
+    return false;
+  }
+
+  LogMessage("Benchmarking flat snapshots of %d records, %d copies, "
+             "%d iterations.",
+             records, copies, iterations);
+  firebase::Variant snapshot = MakeSyntheticSnapshot(records);
+
+  // Retain copies the way a listener would. The flat copies are made first
+  // and kept alive while the Variant copies are made, so that neither reuses
+  // memory the other freed.
+  int64_t baseline = GetResidentMemoryBytes();
+  std::vector<FlatSnapshot> flat_copies;
+  flat_copies.reserve(copies);
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < copies; i++) flat_copies.emplace_back(snapshot);
+  double flat_copy_seconds = SecondsSince(start);
+  int64_t flat_memory = GetResidentMemoryBytes();
+
+  std::vector<firebase::Variant> variant_copies;
+  variant_copies.reserve(copies);
+  start = Clock::now();
+  for (int i = 0; i < copies; i++) variant_copies.push_back(snapshot);
+  double variant_copy_seconds = SecondsSince(start);
+  int64_t variant_memory = GetResidentMemoryBytes();
+
+  const FlatSnapshot& flat = flat_copies.front();
+  if (!(flat.root().ToVariant() == snapshot)) {
+    LogMessage("ERROR: The flat snapshot doesn't match the original.");
+    return false;
+  }
+
+  // Walk every node.
+  Totals variant_totals = Totals();
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) Walk(snapshot, &variant_totals);
+  double variant_walk_seconds = SecondsSince(start);
+
+  Totals flat_totals = Totals();
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) Walk(flat.root(), &flat_totals);
+  double flat_walk_seconds = SecondsSince(start);
+
+  // Look up one field of every record by key.
+  int64_t variant_ages = 0;
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    for (int record = 0; record < records; record++) {
+      char key[32];
+      snprintf(key, sizeof(key), "user_%06d", record);
+      auto found = snapshot.map().find(firebase::Variant(key));
+      if (found == snapshot.map().end()) continue;
+      auto age = found->second.map().find(firebase::Variant("age"));
+      if (age != found->second.map().end()) {
+        variant_ages += age->second.int64_value();
+      }
+    }
+  }
+  double variant_lookup_seconds = SecondsSince(start);
+
+  int64_t flat_ages = 0;
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    for (int record = 0; record < records; record++) {
+      char key[32];
+      snprintf(key, sizeof(key), "user_%06d", record);
+      flat_ages += flat.root().Child(key).Child("age").int64_value();
+    }
+  }
+  double flat_lookup_seconds = SecondsSince(start);
+
+  if (variant_totals.nodes != flat_totals.nodes ||
+      variant_totals.checksum != flat_totals.checksum ||
+      variant_ages != flat_ages) {
+    LogMessage("ERROR: The traversals disagree about the snapshot.");
+    return false;
+  }
+
+  LogMessage("  %d nodes, flat snapshot of %.2f MB.",
+             static_cast<int>(flat.node_count()),
+             Megabytes(static_cast<double>(flat.size_bytes())));
+  LogMemory("Flat copies", baseline, flat_memory, copies);
+  LogMemory("Variant copies", flat_memory, variant_memory, copies);
+  LogMessage("  Copy: Variant %.2f ms, flat %.2f ms per copy.",
+             variant_copy_seconds * 1000.0 / copies,
+             flat_copy_seconds * 1000.0 / copies);
+  LogMessage("  Walk: Variant %.2f ms, flat %.2f ms per walk (%.1fx).",
+             variant_walk_seconds * 1000.0 / iterations,
+             flat_walk_seconds * 1000.0 / iterations,
+             flat_walk_seconds > 0 ? variant_walk_seconds / flat_walk_seconds
+                                   : 0);
+  LogMessage("  Lookup: Variant %.2f us, flat %.2f us per record (%.1fx).",
+             variant_lookup_seconds * 1e6 / records / iterations,
+             flat_lookup_seconds * 1e6 / records / iterations,
+             flat_lookup_seconds > 0
+                 ? variant_lookup_seconds / flat_lookup_seconds
+                 : 0);
+  LogMessage("SUCCESS: Flat snapshot benchmark complete.");
+  return true;
+}
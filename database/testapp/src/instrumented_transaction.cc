@@ -0,0 +1,144 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "instrumented_transaction.h"  // NOLINT
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "firebase/future.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kPollMs = 1;
+
+double SecondsBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// Whether a run that failed with error may succeed if it is run again.
+bool IsRetryable(firebase::database::Error error) {
+  switch (error) {
+    case firebase::database::kErrorMaxRetries:
+    case firebase::database::kErrorDisconnected:
+    case firebase::database::kErrorNetworkError:
+    case firebase::database::kErrorUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+int BackoffDelayMs(const TransactionBackoff& backoff, int completed_runs) {
+  double delay = backoff.initial_delay_ms;
+  for (int i = 1; i < completed_runs && delay < backoff.max_delay_ms; i++) {
+    delay *= backoff.multiplier;
+  }
+  delay = std::min(delay, static_cast<double>(backoff.max_delay_ms));
+  if (backoff.jitter) {
+    static std::mutex random_mutex;
+    static std::minstd_rand random(static_cast<std::minstd_rand::result_type>(
+        Clock::now().time_since_epoch().count()));
+    std::lock_guard<std::mutex> lock(random_mutex);
+    delay *= std::uniform_real_distribution<double>(0.5, 1.0)(random);
+  }
+  return static_cast<int>(delay);
+}
+
+}  // namespace
+
+firebase::database::Error RunInstrumentedTransaction(
+    firebase::database::DatabaseReference reference,
+    const firebase::database::DoTransactionFunction& function,
+    const TransactionBackoff& backoff, TransactionStats* stats,
+    firebase::database::DataSnapshot* result) {
+  *stats = TransactionStats();
+  // The transaction function runs on a database thread.
+  std::mutex mutex;
+  firebase::database::TransactionResult last_result =
+      firebase::database::kTransactionResultSuccess;
+  firebase::database::Error error = firebase::database::kErrorNone;
+  for (;;) {
+    stats->runs++;
+    Clock::time_point run_start = Clock::now();
+    double run_function_seconds = 0;
+    firebase::Future<firebase::database::DataSnapshot> future =
+        reference.RunTransaction(
+            [&](firebase::database::MutableData* data) {
+              Clock::time_point start = Clock::now();
+              firebase::database::TransactionResult function_result =
+                  function(data);
+              double seconds = SecondsBetween(start, Clock::now());
+              std::lock_guard<std::mutex> lock(mutex);
+              stats->attempts++;
+              run_function_seconds += seconds;
+              last_result = function_result;
+              return function_result;
+            });
+    while (future.status() == firebase::kFutureStatusPending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+
+    // The future may complete before the database thread releases the mutex.
+    firebase::database::TransactionResult function_result;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      function_result = last_result;
+      stats->function_seconds += run_function_seconds;
+      stats->wait_seconds +=
+          SecondsBetween(run_start, Clock::now()) - run_function_seconds;
+    }
+    error = future.status() == firebase::kFutureStatusComplete
+                ? static_cast<firebase::database::Error>(future.error())
+                : firebase::database::kErrorUnknownError;
+    if (error == firebase::database::kErrorNone) {
+      stats->committed = true;
+      if (result) *result = *future.result();
+      break;
+    }
+    if (error == firebase::database::kErrorTransactionAbortedByUser ||
+        function_result == firebase::database::kTransactionResultAbort) {
+      stats->user_aborts++;
+      break;
+    }
+    stats->failures[error]++;
+    if (!IsRetryable(error) || stats->runs >= backoff.max_runs) break;
+
+    int delay_ms = BackoffDelayMs(backoff, stats->runs);
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    stats->backoff_seconds += delay_ms / 1000.0;
+  }
+  return error;
+}
+
+void LogTransactionStats(const char* name, const TransactionStats& stats) {
+  LogMessage(
+      "  %s: %d runs, %d attempts (%d wasted), %d user aborts, %.1f ms in the "
+      "transaction function, %.1f ms waiting, %.1f ms backing off.",
+      name, stats.runs, stats.attempts, stats.wasted_attempts(),
+      stats.user_aborts, stats.function_seconds * 1000.0,
+      stats.wait_seconds * 1000.0, stats.backoff_seconds * 1000.0);
+  for (auto it = stats.failures.begin(); it != stats.failures.end(); ++it) {
+    LogMessage("    %d runs failed with error %d: %s", it->second, it->first,
+               firebase::database::GetErrorMessage(it->first));
+  }
+}
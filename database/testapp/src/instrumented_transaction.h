@@ -0,0 +1,91 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_INSTRUMENTED_TRANSACTION_H_  // NOLINT
+#define FIREBASE_TESTAPP_INSTRUMENTED_TRANSACTION_H_  // NOLINT
+
+#include <map>
+
+#include "firebase/database.h"
+
+// How RunInstrumentedTransaction() retries a transaction that the database
+// gave up on. The database already reruns the transaction function whenever
+// it ran against stale data; these retries add a growing, jittered delay
+// between whole transactions so that contending clients spread out instead
+// of colliding again straight away.
+struct TransactionBackoff {
+  TransactionBackoff()
+      : max_runs(3),
+        initial_delay_ms(100),
+        multiplier(2.0),
+        max_delay_ms(5000),
+        jitter(true) {}
+
+  // Number of times RunTransaction() is called before giving up. 1 disables
+  // retries.
+  int max_runs;
+  // Delay before the second run, multiplied by multiplier for each further
+  // run up to max_delay_ms.
+  int initial_delay_ms;
+  double multiplier;
+  int max_delay_ms;
+  // Whether to pick each delay at random between half and all of it.
+  bool jitter;
+};
+
+// Where the time and work of a transaction went.
+struct TransactionStats {
+  TransactionStats()
+      : runs(0),
+        attempts(0),
+        user_aborts(0),
+        function_seconds(0),
+        wait_seconds(0),
+        backoff_seconds(0),
+        committed(false) {}
+
+  // Calls to RunTransaction().
+  int runs;
+  // Calls to the transaction function, over all runs. Every attempt after
+  // the first of each run is work thrown away because of contention.
+  int attempts;
+  // Runs that the transaction function aborted.
+  int user_aborts;
+  // Other runs that failed, by error.
+  std::map<firebase::database::Error, int> failures;
+  // Time spent in the transaction function, waiting for the database and
+  // backing off between runs.
+  double function_seconds;
+  double wait_seconds;
+  double backoff_seconds;
+  bool committed;
+
+  int wasted_attempts() const { return attempts - runs; }
+};
+
+// Runs function as a transaction on reference and waits for it to complete,
+// recording what happened in stats. If the database gives up on the
+// transaction because of contention or a lost connection, it is run again
+// according to backoff. Returns the error of the last run, and stores the
+// committed value in result if it is given. May be called from any thread.
+firebase::database::Error RunInstrumentedTransaction(
+    firebase::database::DatabaseReference reference,
+    const firebase::database::DoTransactionFunction& function,
+    const TransactionBackoff& backoff, TransactionStats* stats,
+    firebase::database::DataSnapshot* result);
+
+// Logs stats, prefixed by name.
+void LogTransactionStats(const char* name, const TransactionStats& stats);
+
+#endif  // FIREBASE_TESTAPP_INSTRUMENTED_TRANSACTION_H_  // NOLINT
@@ -0,0 +1,344 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "benchmarks.h"    // NOLINT
+#include "firebase/variant.h"
+#include "variant_json.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// The straightforward codec that the benchmark compares against: recursive,
+// one character at a time, building every value by copy.
+
+void NaiveAppendString(const std::string& value, std::string* json) {
+  *json += '"';
+  for (size_t i = 0; i < value.size(); i++) {
+    char c = value[i];
+    switch (c) {
+      case '"':
+        *json += "\\\"";
+        break;
+      case '\\':
+        *json += "\\\\";
+        break;
+      case '\n':
+        *json += "\\n";
+        break;
+      case '\r':
+        *json += "\\r";
+        break;
+      case '\t':
+        *json += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escape[8];
+          snprintf(escape, sizeof(escape), "\\u%04x", c);
+          *json += escape;
+        } else {
+          *json += c;
+        }
+    }
+  }
+  *json += '"';
+}
+
+void NaiveToJson(const firebase::Variant& value, std::string* json) {
+  if (value.is_map()) {
+    *json += '{';
+    bool first = true;
+    for (auto it = value.map().begin(); it != value.map().end(); ++it) {
+      if (!first) *json += ',';
+      first = false;
+      NaiveAppendString(it->first.AsString().string_value(), json);
+      *json += ':';
+      NaiveToJson(it->second, json);
+    }
+    *json += '}';
+  } else if (value.is_vector()) {
+    *json += '[';
+    for (size_t i = 0; i < value.vector().size(); i++) {
+      if (i) *json += ',';
+      NaiveToJson(value.vector()[i], json);
+    }
+    *json += ']';
+  } else if (value.is_string()) {
+    NaiveAppendString(value.string_value(), json);
+  } else if (value.is_int64()) {
+    *json += std::to_string(value.int64_value());
+  } else if (value.is_double() && std::isfinite(value.double_value())) {
+    char number[32];
+    snprintf(number, sizeof(number), "%.17g", value.double_value());
+    *json += number;
+    if (!strpbrk(number, ".e")) *json += ".0";
+  } else if (value.is_bool()) {
+    *json += value.bool_value() ? "true" : "false";
+  } else {
+    *json += "null";
+  }
+}
+
+class NaiveParser {
+ public:
+  explicit NaiveParser(const std::string& json) : json_(json), pos_(0) {}
+
+  bool Parse(firebase::Variant* value) {
+    *value = ParseValue();
+    SkipSpace();
+    return ok_ && pos_ == json_.size();
+  }
+
+ private:
+  char Peek() { return pos_ < json_.size() ? json_[pos_] : '\0'; }
+
+  void SkipSpace() {
+    while (pos_ < json_.size() &&
+           isspace(static_cast<unsigned char>(json_[pos_]))) {
+      pos_++;
+    }
+  }
+
+  bool Consume(const char* literal) {
+    size_t length = strlen(literal);
+    if (json_.compare(pos_, length, literal) != 0) return false;
+    pos_ += length;
+    return true;
+  }
+
+  firebase::Variant ParseValue() {
+    SkipSpace();
+    char c = Peek();
+    if (c == '{') {
+      pos_++;
+      firebase::Variant map = firebase::Variant::EmptyMap();
+      SkipSpace();
+      if (Peek() == '}') {
+        pos_++;
+        return map;
+      }
+      while (ok_) {
+        SkipSpace();
+        std::string key = ParseString();
+        SkipSpace();
+        if (Peek() != ':') ok_ = false;
+        pos_++;
+        map.map()[firebase::Variant(key)] = ParseValue();
+        SkipSpace();
+        if (Peek() == '}') {
+          pos_++;
+          break;
+        }
+        if (Peek() != ',') ok_ = false;
+        pos_++;
+      }
+      return map;
+    }
+    if (c == '[') {
+      pos_++;
+      firebase::Variant vector = firebase::Variant::EmptyVector();
+      SkipSpace();
+      if (Peek() == ']') {
+        pos_++;
+        return vector;
+      }
+      while (ok_) {
+        vector.vector().push_back(ParseValue());
+        SkipSpace();
+        if (Peek() == ']') {
+          pos_++;
+          break;
+        }
+        if (Peek() != ',') ok_ = false;
+        pos_++;
+      }
+      return vector;
+    }
+    if (c == '"') return firebase::Variant(ParseString());
+    if (Consume("true")) return firebase::Variant(true);
+    if (Consume("false")) return firebase::Variant(false);
+    if (Consume("null")) return firebase::Variant::Null();
+    size_t start = pos_;
+    bool integral = true;
+    while (pos_ < json_.size() && strchr("+-0123456789.eE", json_[pos_])) {
+      if (!isdigit(static_cast<unsigned char>(json_[pos_])) &&
+          json_[pos_] != '-') {
+        integral = false;
+      }
+      pos_++;
+    }
+    if (start == pos_) {
+      ok_ = false;
+      return firebase::Variant::Null();
+    }
+    std::string number = json_.substr(start, pos_ - start);
+    if (integral) {
+      return firebase::Variant(
+          static_cast<int64_t>(strtoll(number.c_str(), nullptr, 10)));
+    }
+    return firebase::Variant(strtod(number.c_str(), nullptr));
+  }
+
+  std::string ParseString() {
+    std::string value;
+    if (Peek() != '"') {
+      ok_ = false;
+      return value;
+    }
+    pos_++;
+    while (pos_ < json_.size() && json_[pos_] != '"') {
+      char c = json_[pos_++];
+      if (c != '\\') {
+        value += c;
+        continue;
+      }
+      c = Peek();
+      pos_++;
+      switch (c) {
+        case 'n':
+          value += '\n';
+          break;
+        case 'r':
+          value += '\r';
+          break;
+        case 't':
+          value += '\t';
+          break;
+        case 'b':
+          value += '\b';
+          break;
+        case 'f':
+          value += '\f';
+          break;
+        case 'u': {
+          std::string digits = json_.substr(pos_, 4);
+          pos_ += 4;
+          AppendUtf8(static_cast<uint32_t>(strtoul(digits.c_str(), nullptr,
+                                                   16)),
+                     &value);
+          break;
+        }
+        default:
+          value += c;
+      }
+    }
+    if (Peek() != '"') ok_ = false;
+    pos_++;
+    return value;
+  }
+
+  const std::string& json_;
+  size_t pos_;
+  bool ok_ = true;
+};
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double MegabytesPerSecond(size_t bytes, int iterations, double seconds) {
+  return seconds > 0 ? bytes * iterations / (1024.0 * 1024.0) / seconds : 0;
+}
+
+}  // namespace
+
+bool RunJsonCodecBenchmark(firebase::database::Database* /*database*/,
+                           int argc, const char* argv[]) {
+  int records = 20000;
+  int iterations = 5;
+  const char* records_arg = GetArgument(argc, argv, "benchmark_records");
+  if (records_arg) records = atoi(records_arg);
+  const char* iterations_arg = GetArgument(argc, argv, "benchmark_iterations");
+  if (iterations_arg) iterations = atoi(iterations_arg);
+  if (records <= 0 || iterations <= 0) {
+    LogMessage("ERROR: --benchmark_records and --benchmark_iterations must be "
+               "positive.");
+    return false;
+  }
+
+  LogMessage("Benchmarking the JSON codec on %d records, %d iterations.",
+             records, iterations);
+  firebase::Variant snapshot = MakeSyntheticSnapshot(records);
+
+  // Serialize.
+  std::string naive_json;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    naive_json.clear();
+    NaiveToJson(snapshot, &naive_json);
+  }
+  double naive_write_seconds = SecondsSince(start);
+
+  JsonBuffer buffer;
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    buffer.Clear();
+    VariantToJson(snapshot, &buffer);
+  }
+  double write_seconds = SecondsSince(start);
+  std::string json = buffer.ToString();
+
+  // Parse.
+  firebase::Variant naive_value;
+  bool naive_ok = true;
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    naive_ok = NaiveParser(json).Parse(&naive_value) && naive_ok;
+  }
+  double naive_read_seconds = SecondsSince(start);
+
+  firebase::Variant value;
+  std::string error;
+  bool ok = true;
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    ok = JsonToVariant(json, &value, &error) && ok;
+  }
+  double read_seconds = SecondsSince(start);
+
+  // Both codecs must agree before their timings mean anything.
+  firebase::Variant from_naive_json;
+  if (!ok || !naive_ok || json != naive_json || !(value == snapshot) ||
+      !(naive_value == snapshot) ||
+      !JsonToVariant(naive_json, &from_naive_json, &error) ||
+      !(from_naive_json == snapshot)) {
+    LogMessage("ERROR: The codecs disagree about the snapshot. %s",
+               error.c_str());
+    return false;
+  }
+
+  LogMessage("  %.1f MB of JSON.", json.size() / (1024.0 * 1024.0));
+  LogMessage("  Serialize: naive %.1f MB/s, VariantToJson %.1f MB/s (%.1fx).",
+             MegabytesPerSecond(json.size(), iterations, naive_write_seconds),
+             MegabytesPerSecond(json.size(), iterations, write_seconds),
+             write_seconds > 0 ? naive_write_seconds / write_seconds : 0);
+  LogMessage("  Parse: naive %.1f MB/s, JsonToVariant %.1f MB/s (%.1fx).",
+             MegabytesPerSecond(json.size(), iterations, naive_read_seconds),
+             MegabytesPerSecond(json.size(), iterations, read_seconds),
+             read_seconds > 0 ? naive_read_seconds / read_seconds : 0);
+  LogMessage("SUCCESS: JSON codec benchmark complete.");
+  return true;
+}
@@ -0,0 +1,86 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "json_exporter.h"  // NOLINT
+
+#include <chrono>
+#include <vector>
+
+#include "firebase/future.h"
+#include "json_writer.h"       // NOLINT
+#include "paginated_reader.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+bool ExportJson(const firebase::database::DatabaseReference& source,
+                const char* path, const JsonExportOptions& options,
+                JsonExportStats* stats) {
+  typedef std::chrono::steady_clock Clock;
+  *stats = JsonExportStats();
+  Clock::time_point start = Clock::now();
+
+  JsonWriter writer;
+  if (!writer.Open(path, options.gzip)) {
+    LogMessage("ERROR: %s", writer.error().c_str());
+    return false;
+  }
+
+  PaginatedReader reader(source, options.page_size);
+  std::vector<firebase::database::DataSnapshot> page;
+  bool has_children = reader.NextPage(&page);
+  if (has_children) {
+    writer.BeginObject();
+    do {
+      for (const auto& child : page) {
+        writer.Member(child.key_string(), child.value());
+      }
+      // Drop this page's snapshots before waiting for the next one.
+      page.clear();
+    } while (reader.NextPage(&page) && !writer.has_error());
+    writer.EndObject();
+  } else if (reader.error() == firebase::database::kErrorNone) {
+    // A leaf value, or no data at all.
+    firebase::Future<firebase::database::DataSnapshot> future =
+        firebase::database::DatabaseReference(source).GetValue();
+    while (future.status() == firebase::kFutureStatusPending) {
+      ProcessEvents(10);
+    }
+    if (future.status() == firebase::kFutureStatusComplete &&
+        future.error() == firebase::database::kErrorNone) {
+      writer.Value(future.result()->value());
+    } else {
+      LogMessage("ERROR: Unable to read %s: %s", source.url().c_str(),
+                 future.error_message() ? future.error_message() : "");
+      writer.Close();
+      return false;
+    }
+  }
+
+  stats->children = reader.children_read();
+  stats->pages = reader.pages_read();
+  bool success = writer.Close();
+  stats->bytes = writer.bytes_written();
+  stats->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  if (!success) {
+    LogMessage("ERROR: %s", writer.error().c_str());
+  }
+  if (reader.error() != firebase::database::kErrorNone) {
+    LogMessage("ERROR: Reading %s failed with error %d: %s",
+               source.url().c_str(), reader.error(),
+               reader.error_message().c_str());
+    success = false;
+  }
+  return success;
+}
@@ -0,0 +1,55 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_JSON_EXPORTER_H_  // NOLINT
+#define FIREBASE_TESTAPP_JSON_EXPORTER_H_  // NOLINT
+
+#include <cstddef>
+
+#include "firebase/database.h"
+
+struct JsonExportOptions {
+  JsonExportOptions() : page_size(1000), gzip(false) {}
+
+  // Number of children fetched by each query.
+  size_t page_size;
+  // Whether to compress the output with gzip.
+  bool gzip;
+};
+
+struct JsonExportStats {
+  JsonExportStats() : children(0), pages(0), bytes(0), seconds(0) {}
+
+  double megabytes_per_second() const {
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+  }
+
+  // Children of the exported location that were written.
+  size_t children;
+  // Queries used to read them.
+  size_t pages;
+  // Bytes of JSON written, before compression.
+  size_t bytes;
+  double seconds;
+};
+
+// Writes the data at source to the file at path as JSON. The children of
+// source are read with a PaginatedReader and written as soon as each page
+// arrives, so no more than one page of data is held in memory. Returns false
+// if the data couldn't be read or the file couldn't be written.
+bool ExportJson(const firebase::database::DatabaseReference& source,
+                const char* path, const JsonExportOptions& options,
+                JsonExportStats* stats);
+
+#endif  // FIREBASE_TESTAPP_JSON_EXPORTER_H_  // NOLINT
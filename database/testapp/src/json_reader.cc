@@ -0,0 +1,323 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "json_reader.h"  // NOLINT
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "variant_json.h"  // NOLINT
+
+static const size_t kReadBufferSize = 64 * 1024;
+
+JsonReader::JsonReader()
+    : file_(nullptr),
+      buffer_(kReadBufferSize),
+      pos_(0),
+      end_(0),
+      consumed_(0) {}
+
+JsonReader::~JsonReader() { Close(); }
+
+bool JsonReader::Open(const char* path) {
+  Close();
+  file_ = fopen(path, "rb");
+  if (!file_) {
+    error_ = std::string("Unable to open ") + path + ": " + strerror(errno);
+    return false;
+  }
+  error_.clear();
+  pos_ = end_ = consumed_ = 0;
+  objects_.clear();
+  return true;
+}
+
+void JsonReader::Close() {
+  if (file_) fclose(file_);
+  file_ = nullptr;
+}
+
+bool JsonReader::Fill() {
+  if (!file_) return false;
+  consumed_ += end_;
+  pos_ = 0;
+  end_ = fread(buffer_.data(), 1, buffer_.size(), file_);
+  return end_ > 0;
+}
+
+int JsonReader::Peek() {
+  if (pos_ == end_ && !Fill()) return EOF;
+  return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+int JsonReader::Get() {
+  int c = Peek();
+  if (c != EOF) pos_++;
+  return c;
+}
+
+void JsonReader::SkipWhitespace() {
+  for (;;) {
+    int c = Peek();
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') return;
+    pos_++;
+  }
+}
+
+bool JsonReader::Expect(char c) {
+  SkipWhitespace();
+  if (Get() == c) return true;
+  char message[32];
+  snprintf(message, sizeof(message), "expected '%c'", c);
+  return Fail(message);
+}
+
+bool JsonReader::Fail(const char* message) {
+  if (error_.empty()) {
+    char where[64];
+    snprintf(where, sizeof(where), " at byte %lu",
+             static_cast<unsigned long>(position()));  // NOLINT
+    error_ = std::string("JSON parse error: ") + message + where;
+  }
+  return false;
+}
+
+bool JsonReader::BeginObject() {
+  if (has_error()) return false;
+  if (depth() > kMaxDepth) return Fail("maximum depth exceeded");
+  if (!Expect('{')) return false;
+  objects_.push_back(false);
+  return true;
+}
+
+bool JsonReader::AtObject() {
+  if (has_error()) return false;
+  SkipWhitespace();
+  return Peek() == '{';
+}
+
+bool JsonReader::NextKey(std::string* key) {
+  if (has_error() || objects_.empty()) return false;
+  SkipWhitespace();
+  if (Peek() == '}') {
+    pos_++;
+    objects_.pop_back();
+    return false;
+  }
+  if (objects_.back() && !Expect(',')) return false;
+  SkipWhitespace();
+  if (!ParseString(key) || !Expect(':')) return false;
+  objects_.back() = true;
+  return true;
+}
+
+bool JsonReader::NextMember(std::string* key, firebase::Variant* value) {
+  return NextKey(key) && ReadValue(value);
+}
+
+bool JsonReader::ReadValue(firebase::Variant* value) {
+  if (has_error()) return false;
+  return ParseValue(value, depth());
+}
+
+bool JsonReader::ParseValue(firebase::Variant* value, int depth) {
+  if (depth > kMaxDepth) return Fail("maximum depth exceeded");
+  SkipWhitespace();
+  switch (Peek()) {
+    case '{': {
+      pos_++;
+      *value = firebase::Variant::EmptyMap();
+      std::map<firebase::Variant, firebase::Variant>& map = value->map();
+      SkipWhitespace();
+      if (Peek() == '}') {
+        pos_++;
+        return true;
+      }
+      for (;;) {
+        std::string key;
+        SkipWhitespace();
+        if (!ParseString(&key) || !Expect(':')) return false;
+        firebase::Variant child;
+        if (!ParseValue(&child, depth + 1)) return false;
+        map[firebase::Variant(key)] = std::move(child);
+        SkipWhitespace();
+        int c = Get();
+        if (c == '}') return true;
+        if (c != ',') return Fail("expected ',' or '}'");
+      }
+    }
+    case '[': {
+      pos_++;
+      *value = firebase::Variant::EmptyVector();
+      std::vector<firebase::Variant>& vector = value->vector();
+      SkipWhitespace();
+      if (Peek() == ']') {
+        pos_++;
+        return true;
+      }
+      for (;;) {
+        vector.push_back(firebase::Variant());
+        if (!ParseValue(&vector.back(), depth + 1)) return false;
+        SkipWhitespace();
+        int c = Get();
+        if (c == ']') return true;
+        if (c != ',') return Fail("expected ',' or ']'");
+      }
+    }
+    case '"': {
+      std::string string;
+      if (!ParseString(&string)) return false;
+      *value = firebase::Variant(string);
+      return true;
+    }
+    case 't':
+      return ParseLiteral("true", firebase::Variant(true), value);
+    case 'f':
+      return ParseLiteral("false", firebase::Variant(false), value);
+    case 'n':
+      return ParseLiteral("null", firebase::Variant::Null(), value);
+    case EOF:
+      return Fail("unexpected end of input");
+    default:
+      return ParseNumber(value);
+  }
+}
+
+bool JsonReader::ParseString(std::string* value) {
+  if (Get() != '"') return Fail("expected a string");
+  value->clear();
+  for (;;) {
+    // Copy runs of plain characters straight out of the buffer.
+    size_t run = FindJsonEscape(buffer_.data() + pos_, end_ - pos_);
+    value->append(buffer_.data() + pos_, run);
+    pos_ += run;
+
+    int c = Get();
+    if (c == '"') return true;
+    if (c == EOF) return Fail("unterminated string");
+    if (c < 0x20) return Fail("control character in string");
+    if (c != '\\') {
+      // The run above stopped at the end of the buffer.
+      value->push_back(static_cast<char>(c));
+      continue;
+    }
+    c = Get();
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        value->push_back(static_cast<char>(c));
+        break;
+      case 'b':
+        value->push_back('\b');
+        break;
+      case 'f':
+        value->push_back('\f');
+        break;
+      case 'n':
+        value->push_back('\n');
+        break;
+      case 'r':
+        value->push_back('\r');
+        break;
+      case 't':
+        value->push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code_point = 0;
+        for (int surrogate = 0; surrogate < 2; surrogate++) {
+          uint32_t unit = 0;
+          for (int i = 0; i < 4; i++) {
+            int h = Get();
+            unit <<= 4;
+            if (h >= '0' && h <= '9') {
+              unit |= h - '0';
+            } else if (h >= 'a' && h <= 'f') {
+              unit |= h - 'a' + 10;
+            } else if (h >= 'A' && h <= 'F') {
+              unit |= h - 'A' + 10;
+            } else {
+              return Fail("invalid \\u escape");
+            }
+          }
+          if (surrogate == 0) {
+            code_point = unit;
+            // A high surrogate must be followed by an escaped low surrogate.
+            if (unit < 0xD800 || unit > 0xDBFF) break;
+            if (Get() != '\\' || Get() != 'u') {
+              return Fail("unpaired surrogate");
+            }
+          } else {
+            if (unit < 0xDC00 || unit > 0xDFFF) {
+              return Fail("unpaired surrogate");
+            }
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                         (unit - 0xDC00);
+          }
+        }
+        AppendUtf8(code_point, value);
+        break;
+      }
+      default:
+        return Fail("invalid escape");
+    }
+  }
+}
+
+bool JsonReader::ParseNumber(firebase::Variant* value) {
+  std::string text;
+  bool integral = true;
+  for (;;) {
+    int c = Peek();
+    if ((c >= '0' && c <= '9') || c == '-' || c == '+') {
+      text.push_back(static_cast<char>(c));
+    } else if (c == '.' || c == 'e' || c == 'E') {
+      text.push_back(static_cast<char>(c));
+      integral = false;
+    } else {
+      break;
+    }
+    pos_++;
+  }
+  if (text.empty()) return Fail("unexpected character");
+  char* end = nullptr;
+  errno = 0;
+  if (integral) {
+    long long integer = strtoll(text.c_str(), &end, 10);  // NOLINT
+    if (errno == 0 && *end == '\0') {
+      *value = firebase::Variant(static_cast<int64_t>(integer));
+      return true;
+    }
+    // Fall back to a double for integers that don't fit in 64 bits.
+    errno = 0;
+  }
+  double number = strtod(text.c_str(), &end);
+  if (*end != '\0') return Fail("invalid number");
+  *value = firebase::Variant(number);
+  return true;
+}
+
+bool JsonReader::ParseLiteral(const char* literal,
+                              const firebase::Variant& value,
+                              firebase::Variant* result) {
+  for (const char* c = literal; *c; c++) {
+    if (Get() != *c) return Fail("invalid literal");
+  }
+  *result = value;
+  return true;
+}
@@ -0,0 +1,107 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_JSON_READER_H_  // NOLINT
+#define FIREBASE_TESTAPP_JSON_READER_H_  // NOLINT
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "firebase/variant.h"
+
+// Reads a JSON file incrementally, through a fixed size buffer, so that files
+// much larger than memory can be processed. The members of the top level
+// object are converted to Variants one at a time:
+//
+//   JsonReader reader;
+//   if (reader.Open(path) && reader.BeginObject()) {
+//     std::string key;
+//     firebase::Variant value;
+//     while (reader.NextMember(&key, &value)) { ... }
+//   }
+//   if (reader.has_error()) LogMessage("%s", reader.error().c_str());
+//
+// A member that is too large to convert at once can be read a member at a
+// time too, by opening its value with BeginObject() after NextKey().
+class JsonReader {
+ public:
+  // JSON nested deeper than this is rejected. The Realtime Database doesn't
+  // store data deeper than 32 levels.
+  static const int kMaxDepth = 32;
+
+  JsonReader();
+  ~JsonReader();
+
+  // Opens the file at path, returns false if it can't be read.
+  bool Open(const char* path);
+  void Close();
+
+  // Consumes the '{' that opens an object: the top level object, or the
+  // value of the member whose key NextKey() just read.
+  bool BeginObject();
+
+  // Whether the next value is an object.
+  bool AtObject();
+
+  // Reads the key of the next member of the innermost open object. Its value
+  // must then be read with ReadValue(), or opened with BeginObject(). Returns
+  // false when the end of the object is reached, which closes it, or the
+  // input is malformed (see has_error()).
+  bool NextKey(std::string* key);
+
+  // Reads the key and value of the next member of the innermost open object.
+  bool NextMember(std::string* key, firebase::Variant* value);
+
+  // Reads a single complete value.
+  bool ReadValue(firebase::Variant* value);
+
+  // Number of objects opened by BeginObject() that are still open.
+  int depth() const { return static_cast<int>(objects_.size()); }
+
+  bool has_error() const { return !error_.empty(); }
+  const std::string& error() const { return error_; }
+
+  // Number of bytes of the file consumed so far.
+  size_t position() const { return consumed_ + pos_; }
+
+ private:
+  int Peek();
+  int Get();
+  bool Fill();
+  void SkipWhitespace();
+  bool Expect(char c);
+  bool Fail(const char* message);
+
+  bool ParseValue(firebase::Variant* value, int depth);
+  bool ParseString(std::string* value);
+  bool ParseNumber(firebase::Variant* value);
+  bool ParseLiteral(const char* literal, const firebase::Variant& value,
+                    firebase::Variant* result);
+
+  FILE* file_;
+  std::vector<char> buffer_;
+  // Read position and end of the valid data in buffer_.
+  size_t pos_;
+  size_t end_;
+  // Number of bytes consumed by previous fills of buffer_.
+  size_t consumed_;
+  // The objects opened by BeginObject() that are still open, innermost
+  // last, and whether a comma is expected before each one's next member.
+  std::vector<bool> objects_;
+  std::string error_;
+};
+
+#endif  // FIREBASE_TESTAPP_JSON_READER_H_  // NOLINT
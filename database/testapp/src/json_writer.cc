@@ -0,0 +1,124 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "json_writer.h"  // NOLINT
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+#include <zlib.h>
+#endif  // defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+
+JsonWriter::JsonWriter()
+    : file_(nullptr), gz_file_(nullptr), buffer_(kFlushSize), flushed_(0) {}
+
+JsonWriter::~JsonWriter() { Close(); }
+
+bool JsonWriter::SupportsGzip() {
+#if defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+  return true;
+#else
+  return false;
+#endif  // defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+}
+
+bool JsonWriter::Open(const char* path, bool gzip) {
+  Close();
+  error_.clear();
+  buffer_.Clear();
+  flushed_ = 0;
+  has_members_.clear();
+  if (gzip) {
+#if defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+    gz_file_ = gzopen(path, "wb");
+    if (!gz_file_) {
+      error_ = std::string("Unable to create ") + path;
+      return false;
+    }
+    return true;
+#else
+    error_ = "gzip output is not supported by this build";
+    return false;
+#endif  // defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+  }
+  file_ = fopen(path, "wb");
+  if (!file_) {
+    error_ = std::string("Unable to create ") + path + ": " + strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool JsonWriter::Close() {
+  if (!file_ && !gz_file_) return !has_error();
+  Flush();
+#if defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+  if (gz_file_ && gzclose(static_cast<gzFile>(gz_file_)) != Z_OK &&
+      !has_error()) {
+    error_ = "Unable to finish compressed output";
+  }
+#endif  // defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+  if (file_ && fclose(file_) != 0 && !has_error()) {
+    error_ = std::string("Unable to close output: ") + strerror(errno);
+  }
+  file_ = nullptr;
+  gz_file_ = nullptr;
+  return !has_error();
+}
+
+void JsonWriter::Flush() {
+  if (buffer_.empty()) return;
+  buffer_.ForEachBlock([this](const char* data, size_t size) {
+    if (has_error()) return;
+#if defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+    if (gz_file_ && gzwrite(static_cast<gzFile>(gz_file_), data,
+                            static_cast<unsigned>(size)) !=
+                        static_cast<int>(size)) {
+      error_ = "Unable to write compressed output";
+    }
+#endif  // defined(FIREBASE_TESTAPP_HAVE_ZLIB)
+    if (file_ && fwrite(data, 1, size, file_) != size) {
+      error_ = std::string("Unable to write output: ") + strerror(errno);
+    }
+  });
+  flushed_ += buffer_.size();
+  buffer_.Clear();
+}
+
+void JsonWriter::BeginObject() {
+  buffer_.Append('{');
+  has_members_.push_back(false);
+}
+
+void JsonWriter::EndObject() {
+  buffer_.Append('}');
+  if (!has_members_.empty()) has_members_.pop_back();
+}
+
+void JsonWriter::Member(const std::string& key,
+                        const firebase::Variant& value) {
+  if (!has_members_.empty()) {
+    if (has_members_.back()) buffer_.Append(',');
+    has_members_.back() = true;
+  }
+  AppendJsonString(key.data(), key.size(), &buffer_);
+  buffer_.Append(':');
+  Value(value);
+}
+
+void JsonWriter::Value(const firebase::Variant& value) {
+  VariantToJson(value, &buffer_);
+  FlushIfFull();
+}
@@ -0,0 +1,81 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_JSON_WRITER_H_  // NOLINT
+#define FIREBASE_TESTAPP_JSON_WRITER_H_  // NOLINT
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "firebase/variant.h"
+#include "variant_json.h"  // NOLINT
+
+// Writes JSON to a file through a fixed size buffer, optionally compressing it
+// with gzip. Objects can be written a member at a time, so that the output
+// never has to be held in memory:
+//
+//   JsonWriter writer;
+//   if (writer.Open(path, false)) {
+//     writer.BeginObject();
+//     writer.Member("key", value);
+//     writer.EndObject();
+//   }
+//   if (!writer.Close()) LogMessage("%s", writer.error().c_str());
+class JsonWriter {
+ public:
+  JsonWriter();
+  ~JsonWriter();
+
+  // Returns whether gzip output is supported by this build.
+  static bool SupportsGzip();
+
+  // Creates the file at path, returns false if it can't be written.
+  bool Open(const char* path, bool gzip);
+  // Flushes and closes the file, returns false if any write failed.
+  bool Close();
+
+  void BeginObject();
+  void EndObject();
+  // Writes one member of the innermost object started with BeginObject().
+  void Member(const std::string& key, const firebase::Variant& value);
+  // Writes a complete value, e.g. as the whole document.
+  void Value(const firebase::Variant& value);
+
+  bool has_error() const { return !error_.empty(); }
+  const std::string& error() const { return error_; }
+
+  // Number of bytes of JSON written so far, before compression.
+  size_t bytes_written() const { return flushed_ + buffer_.size(); }
+
+ private:
+  void FlushIfFull() {
+    if (buffer_.size() >= kFlushSize) Flush();
+  }
+  void Flush();
+
+  static const size_t kFlushSize = 64 * 1024;
+
+  FILE* file_;
+  // A gzFile when writing compressed output.
+  void* gz_file_;
+  JsonBuffer buffer_;
+  size_t flushed_;
+  // For each open object, whether it already has a member.
+  std::vector<bool> has_members_;
+  std::string error_;
+};
+
+#endif  // FIREBASE_TESTAPP_JSON_WRITER_H_  // NOLINT
@@ -0,0 +1,177 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "local_index.h"  // NOLINT
+
+#include <cstring>
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+// Rank of each kind of value in the database's ordering.
+int Rank(const firebase::Variant& value) {
+  if (value.is_bool()) return 1;
+  if (value.is_numeric()) return 2;
+  if (value.is_string()) return 3;
+  if (value.is_container_type()) return 4;
+  return 0;
+}
+
+}  // namespace
+
+int CompareDatabaseValues(const firebase::Variant& a,
+                          const firebase::Variant& b) {
+  int rank_a = Rank(a);
+  int rank_b = Rank(b);
+  if (rank_a != rank_b) return rank_a - rank_b;
+  switch (rank_a) {
+    case 1:
+      return static_cast<int>(a.bool_value()) -
+             static_cast<int>(b.bool_value());
+    case 2: {
+      if (a.is_int64() && b.is_int64()) {
+        return a.int64_value() < b.int64_value()   ? -1
+               : a.int64_value() > b.int64_value() ? 1
+                                                   : 0;
+      }
+      double x = a.AsDouble().double_value();
+      double y = b.AsDouble().double_value();
+      return x < y ? -1 : x > y ? 1 : 0;
+    }
+    case 3:
+      return strcmp(a.string_value(), b.string_value());
+    default:
+      // Nulls are all equal, and the database orders objects by key alone.
+      return 0;
+  }
+}
+
+LocalIndex::LocalIndex(const firebase::database::DatabaseReference& location,
+                       const std::vector<std::string>& fields)
+    : location_(location),
+      fields_(fields),
+      updater_(this),
+      indexes_(fields.size()) {
+  location_.AddChildListener(&updater_);
+}
+
+LocalIndex::~LocalIndex() { location_.RemoveChildListener(&updater_); }
+
+bool LocalIndex::Range(const std::string& field,
+                       const firebase::Variant& start,
+                       const firebase::Variant& end, size_t limit,
+                       std::vector<std::string>* keys) const {
+  keys->clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Index* index = FindIndex(field);
+  if (!index) return false;
+  // The empty key sorts before any other, so this finds the first entry with
+  // a value of at least start.
+  Entry first = {start, std::string()};
+  for (auto it = index->lower_bound(first); it != index->end(); ++it) {
+    if (CompareDatabaseValues(it->value, end) > 0) break;
+    if (limit && keys->size() == limit) break;
+    keys->push_back(it->key);
+  }
+  return true;
+}
+
+bool LocalIndex::Top(const std::string& field, size_t k,
+                     std::vector<std::string>* keys) const {
+  keys->clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Index* index = FindIndex(field);
+  if (!index) return false;
+  for (auto it = index->rbegin(); it != index->rend() && keys->size() < k;
+       ++it) {
+    keys->push_back(it->key);
+  }
+  return true;
+}
+
+size_t LocalIndex::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return children_.size();
+}
+
+void LocalIndex::Update(const firebase::database::DataSnapshot& snapshot) {
+  std::string key = snapshot.key_string();
+  std::vector<firebase::Variant> values;
+  values.reserve(fields_.size());
+  for (const std::string& field : fields_) {
+    values.push_back(snapshot.Child(field).value());
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveLocked(key);
+  for (size_t i = 0; i < fields_.size(); i++) {
+    Entry entry = {values[i], key};
+    indexes_[i].insert(entry);
+  }
+  children_[key].swap(values);
+}
+
+void LocalIndex::Remove(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveLocked(key);
+}
+
+void LocalIndex::RemoveLocked(const std::string& key) {
+  auto child = children_.find(key);
+  if (child == children_.end()) return;
+  for (size_t i = 0; i < fields_.size(); i++) {
+    Entry entry = {child->second[i], key};
+    indexes_[i].erase(entry);
+  }
+  children_.erase(child);
+}
+
+const LocalIndex::Index* LocalIndex::FindIndex(
+    const std::string& field) const {
+  for (size_t i = 0; i < fields_.size(); i++) {
+    if (fields_[i] == field) return &indexes_[i];
+  }
+  return nullptr;
+}
+
+void LocalIndex::Updater::OnChildAdded(
+    const firebase::database::DataSnapshot& snapshot,
+    const char* previous_sibling) {
+  index_->Update(snapshot);
+}
+
+void LocalIndex::Updater::OnChildChanged(
+    const firebase::database::DataSnapshot& snapshot,
+    const char* previous_sibling) {
+  index_->Update(snapshot);
+}
+
+void LocalIndex::Updater::OnChildMoved(
+    const firebase::database::DataSnapshot& snapshot,
+    const char* previous_sibling) {
+  // A move follows a change, but the snapshot is the latest either way.
+  index_->Update(snapshot);
+}
+
+void LocalIndex::Updater::OnChildRemoved(
+    const firebase::database::DataSnapshot& snapshot) {
+  index_->Remove(snapshot.key_string());
+}
+
+void LocalIndex::Updater::OnCancelled(
+    const firebase::database::Error& error_code, const char* error_message) {
+  LogMessage("ERROR: LocalIndex listener canceled: %d: %s", error_code,
+             error_message);
+}
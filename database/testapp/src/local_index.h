@@ -0,0 +1,119 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_LOCAL_INDEX_H_  // NOLINT
+#define FIREBASE_TESTAPP_LOCAL_INDEX_H_  // NOLINT
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "firebase/database.h"
+#include "firebase/variant.h"
+
+// Orders Variants the way the database orders children by a value: nulls
+// (children without the value) first, then false, true, numbers, strings and
+// finally objects. Returns a negative number, zero or a positive number.
+int CompareDatabaseValues(const firebase::Variant& a,
+                          const firebase::Variant& b);
+
+// Indexes the children of a location on several fields at once, so that
+// range and top-K queries on any of them are answered locally instead of
+// with a separate server query per ordering.
+//
+// The index keeps itself current with a ChildListener on the location, which
+// first reports every existing child and then each change. Only the indexed
+// fields are held, so the keys returned by a query are read with the
+// location's Child(), which the listener also keeps synced locally:
+//
+//   LocalIndex index(players, {"score", "stats/level"});
+//   std::vector<std::string> keys;
+//   index.Top("score", 10, &keys);
+//   index.Range("stats/level", 5, 10, 0, &keys);
+class LocalIndex {
+ public:
+  // Indexes the children of location on each of fields, which are child
+  // paths such as "score" or "stats/level".
+  LocalIndex(const firebase::database::DatabaseReference& location,
+             const std::vector<std::string>& fields);
+  ~LocalIndex();
+
+  // Sets keys to the children whose field lies between start and end,
+  // inclusive, in ascending order (ties broken by key), at most limit of them
+  // if limit isn't 0. Returns false if field isn't indexed.
+  bool Range(const std::string& field, const firebase::Variant& start,
+             const firebase::Variant& end, size_t limit,
+             std::vector<std::string>* keys) const;
+  // Sets keys to the k children with the highest field, highest first.
+  // Returns false if field isn't indexed.
+  bool Top(const std::string& field, size_t k,
+           std::vector<std::string>* keys) const;
+
+  // Number of children indexed.
+  size_t size() const;
+
+ private:
+  class Updater : public firebase::database::ChildListener {
+   public:
+    explicit Updater(LocalIndex* index) : index_(index) {}
+    void OnChildAdded(const firebase::database::DataSnapshot& snapshot,
+                      const char* previous_sibling) override;
+    void OnChildChanged(const firebase::database::DataSnapshot& snapshot,
+                        const char* previous_sibling) override;
+    void OnChildMoved(const firebase::database::DataSnapshot& snapshot,
+                      const char* previous_sibling) override;
+    void OnChildRemoved(
+        const firebase::database::DataSnapshot& snapshot) override;
+    void OnCancelled(const firebase::database::Error& error_code,
+                     const char* error_message) override;
+
+   private:
+    LocalIndex* index_;
+  };
+
+  struct Entry {
+    firebase::Variant value;
+    std::string key;
+  };
+
+  struct EntryLess {
+    bool operator()(const Entry& a, const Entry& b) const {
+      int order = CompareDatabaseValues(a.value, b.value);
+      return order != 0 ? order < 0 : a.key < b.key;
+    }
+  };
+
+  typedef std::set<Entry, EntryLess> Index;
+
+  // Adds or replaces the entries of a child.
+  void Update(const firebase::database::DataSnapshot& snapshot);
+  void Remove(const std::string& key);
+  void RemoveLocked(const std::string& key);
+  const Index* FindIndex(const std::string& field) const;
+
+  firebase::database::DatabaseReference location_;
+  std::vector<std::string> fields_;
+  Updater updater_;
+  mutable std::mutex mutex_;
+  // One ordered index per field, in the order of fields_.
+  std::vector<Index> indexes_;
+  // The indexed values of each child, in the order of fields_, to find its
+  // entries again when it changes.
+  std::map<std::string, std::vector<firebase::Variant>> children_;
+};
+
+#endif  // FIREBASE_TESTAPP_LOCAL_INDEX_H_  // NOLINT
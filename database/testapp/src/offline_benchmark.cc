@@ -0,0 +1,164 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"     // NOLINT
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "process_stats.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kPollMs = 1;
+// How many times the growth of the write queue is sampled while offline.
+const int kGrowthSamples = 10;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double Megabytes(int64_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+// Logs the memory and disk use relative to the baseline. Either is skipped if
+// it can't be measured.
+void LogFootprint(const char* label, int64_t memory_baseline,
+                  int64_t disk_baseline, const char* persistence_dir) {
+  int64_t memory = GetResidentMemoryBytes();
+  int64_t disk = persistence_dir ? GetDirectorySize(persistence_dir) : -1;
+  char memory_text[64] = "unknown";
+  char disk_text[64] = "unknown";
+  if (memory >= 0 && memory_baseline >= 0) {
+    snprintf(memory_text, sizeof(memory_text), "%+.2f MB",
+             Megabytes(memory - memory_baseline));
+  }
+  if (disk >= 0 && disk_baseline >= 0) {
+    snprintf(disk_text, sizeof(disk_text), "%+.2f MB",
+             Megabytes(disk - disk_baseline));
+  }
+  LogMessage("  %s: memory %s, persistence %s.", label, memory_text,
+             disk_text);
+}
+
+}  // namespace
+
+bool RunOfflineBenchmark(firebase::database::Database* database, int argc,
+                         const char* argv[]) {
+  int num_writes = 1000;
+  int write_bytes = 1024;
+  const char* writes_arg = GetArgument(argc, argv, "benchmark_writes");
+  if (writes_arg) num_writes = atoi(writes_arg);
+  const char* bytes_arg = GetArgument(argc, argv, "benchmark_write_bytes");
+  if (bytes_arg) write_bytes = atoi(bytes_arg);
+  const char* persistence_dir =
+      GetArgument(argc, argv, "benchmark_persistence_dir");
+  if (num_writes <= 0 || write_bytes <= 0) {
+    LogMessage("ERROR: --benchmark_writes and --benchmark_write_bytes must be "
+               "positive.");
+    return false;
+  }
+  LogMessage("Benchmarking offline replay of %d writes of %d bytes.",
+             num_writes, write_bytes);
+
+  // Make sure we're connected, so that the queue starts out empty.
+  firebase::database::DatabaseReference location =
+      database->GetReference("benchmarks").PushChild();
+  firebase::Future<void> connected = location.Child("started").SetValue(true);
+  while (connected.status() == firebase::kFutureStatusPending) {
+    ProcessEvents(10);
+  }
+  if (connected.error() != firebase::database::kErrorNone) {
+    LogMessage("ERROR: Unable to write to the database: %s",
+               connected.error_message());
+    return false;
+  }
+
+  int64_t memory_baseline = GetResidentMemoryBytes();
+  int64_t disk_baseline =
+      persistence_dir ? GetDirectorySize(persistence_dir) : -1;
+  if (persistence_dir && disk_baseline < 0) {
+    LogMessage("  Unable to read %s, not measuring persistence.",
+               persistence_dir);
+  }
+
+  // Queue the writes while offline.
+  database->GoOffline();
+  std::string payload(write_bytes, 'x');
+  std::vector<firebase::Future<void>> writes;
+  writes.reserve(num_writes);
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < num_writes; i++) {
+    char key[32];
+    snprintf(key, sizeof(key), "write_%08d", i);
+    writes.push_back(location.Child("writes").Child(key).SetValue(payload));
+    if ((i + 1) % ((num_writes + kGrowthSamples - 1) / kGrowthSamples) == 0) {
+      char label[64];
+      snprintf(label, sizeof(label), "%d writes queued", i + 1);
+      LogFootprint(label, memory_baseline, disk_baseline, persistence_dir);
+    }
+  }
+  double queue_seconds = SecondsSince(start);
+  LogMessage("  Queued %d writes in %.2f s (%.0f writes/s).", num_writes,
+             queue_seconds, queue_seconds > 0 ? num_writes / queue_seconds : 0);
+  // Give persistence a moment to catch up before measuring the full queue.
+  ProcessEvents(1000);
+  LogFootprint("Queue complete", memory_baseline, disk_baseline,
+               persistence_dir);
+
+  // Replay the queue.
+  start = Clock::now();
+  database->GoOnline();
+  // Writes are acknowledged in the order they were queued, so it's enough to
+  // wait for each in turn.
+  double first_ack_seconds = -1;
+  size_t completed = 0;
+  size_t failed = 0;
+  while (completed < writes.size()) {
+    if (writes[completed].status() == firebase::kFutureStatusPending) {
+      if (ProcessEvents(kPollMs)) break;
+      continue;
+    }
+    if (writes[completed].error() != firebase::database::kErrorNone) failed++;
+    if (first_ack_seconds < 0) first_ack_seconds = SecondsSince(start);
+    completed++;
+  }
+  double drain_seconds = SecondsSince(start);
+  LogMessage(
+      "  Replayed %d writes in %.2f s, first acknowledged after %.2f s: %.0f "
+      "writes/s, %.2f MB/s, %d failed.",
+      static_cast<int>(completed), drain_seconds, first_ack_seconds,
+      drain_seconds > 0 ? completed / drain_seconds : 0,
+      drain_seconds > 0 ? Megabytes(static_cast<int64_t>(completed) *
+                                    write_bytes) / drain_seconds
+                        : 0,
+      static_cast<int>(failed));
+  LogFootprint("Queue drained", memory_baseline, disk_baseline,
+               persistence_dir);
+
+  firebase::Future<void> cleanup = location.RemoveValue();
+  while (cleanup.status() == firebase::kFutureStatusPending) ProcessEvents(10);
+  bool success = completed == writes.size() && failed == 0;
+  LogMessage(success ? "SUCCESS: Offline benchmark complete."
+                     : "ERROR: Offline benchmark failed.");
+  return success;
+}
@@ -0,0 +1,99 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paginated_reader.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+// How long to sleep between checks of a pending page request.
+static const int kPagePollMs = 10;
+
+PaginatedReader::PaginatedReader(
+    const firebase::database::DatabaseReference& location, size_t page_size)
+    : location_(location),
+      page_size_(page_size > 0 ? page_size : 1),
+      pending_limit_(0),
+      done_(false),
+      error_(firebase::database::kErrorNone),
+      pages_read_(0),
+      children_read_(0) {
+  RequestPage(std::string());
+}
+
+void PaginatedReader::RequestPage(const std::string& start_key) {
+  firebase::database::Query query = location_.OrderByKey();
+  if (start_key.empty()) {
+    pending_limit_ = page_size_;
+  } else {
+    // StartAt() is inclusive, so ask for one extra child to make up for the
+    // one that was already returned as part of the previous page.
+    query = query.StartAt(start_key.c_str());
+    pending_limit_ = page_size_ + 1;
+  }
+  pending_start_key_ = start_key;
+  pending_ = query.LimitToFirst(pending_limit_).GetValue();
+}
+
+bool PaginatedReader::NextPage(
+    std::vector<firebase::database::DataSnapshot>* page) {
+  page->clear();
+  if (done_) return false;
+  while (pending_.status() == firebase::kFutureStatusPending) {
+    ProcessEvents(kPagePollMs);
+  }
+  if (pending_.status() != firebase::kFutureStatusComplete ||
+      pending_.error() != firebase::database::kErrorNone) {
+    error_ = pending_.status() == firebase::kFutureStatusComplete
+                 ? static_cast<firebase::database::Error>(pending_.error())
+                 : firebase::database::kErrorUnknownError;
+    error_message_ = pending_.error_message() ? pending_.error_message() : "";
+    pending_.Release();
+    done_ = true;
+    return false;
+  }
+
+  *page = pending_.result()->children();
+  size_t fetched = page->size();
+  if (!pending_start_key_.empty() && !page->empty() &&
+      page->front().key_string() == pending_start_key_) {
+    page->erase(page->begin());
+  }
+  // A short page means the end of the location has been reached; otherwise
+  // prefetch the next page while the caller works on this one.
+  if (fetched < pending_limit_ || page->empty()) {
+    pending_.Release();
+    done_ = true;
+  } else {
+    RequestPage(page->back().key_string());
+  }
+  if (page->empty()) return false;
+  pages_read_++;
+  children_read_ += page->size();
+  return true;
+}
+
+firebase::database::Error ForEachChild(
+    const firebase::database::DatabaseReference& location, size_t page_size,
+    const std::function<bool(const firebase::database::DataSnapshot&)>&
+        callback) {
+  PaginatedReader reader(location, page_size);
+  std::vector<firebase::database::DataSnapshot> page;
+  while (reader.NextPage(&page)) {
+    for (const auto& child : page) {
+      if (!callback(child)) return firebase::database::kErrorNone;
+    }
+  }
+  return reader.error();
+}
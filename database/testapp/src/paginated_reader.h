@@ -0,0 +1,74 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_PAGINATED_READER_H_  // NOLINT
+#define FIREBASE_TESTAPP_PAGINATED_READER_H_  // NOLINT
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "firebase/database.h"
+#include "firebase/future.h"
+
+// Reads the children of a database location a page at a time, in key order,
+// instead of materializing the whole location with a single GetValue().
+//
+// Each page is fetched with OrderByKey().StartAt(last_key).LimitToFirst(n),
+// and the request for the next page is issued as soon as the previous one
+// arrives, so at most two pages are held in memory at once.
+class PaginatedReader {
+ public:
+  PaginatedReader(const firebase::database::DatabaseReference& location,
+                  size_t page_size);
+
+  // Waits for the next page of children and stores it in page. Returns false
+  // once every child has been read, or if a request failed, in which case
+  // error() describes the failure.
+  bool NextPage(std::vector<firebase::database::DataSnapshot>* page);
+
+  firebase::database::Error error() const { return error_; }
+  const std::string& error_message() const { return error_message_; }
+  size_t pages_read() const { return pages_read_; }
+  size_t children_read() const { return children_read_; }
+
+ private:
+  // Requests the page that starts at start_key, or the first page if
+  // start_key is empty.
+  void RequestPage(const std::string& start_key);
+
+  firebase::database::DatabaseReference location_;
+  size_t page_size_;
+  // The request for the next page, and the key it starts at. The child with
+  // that key was the last child of the previous page, so it is skipped.
+  firebase::Future<firebase::database::DataSnapshot> pending_;
+  std::string pending_start_key_;
+  size_t pending_limit_;
+  bool done_;
+  firebase::database::Error error_;
+  std::string error_message_;
+  size_t pages_read_;
+  size_t children_read_;
+};
+
+// Calls callback with each child of location in key order, reading page_size
+// children at a time. Stops early if callback returns false. Returns the error
+// of the request that failed, if any.
+firebase::database::Error ForEachChild(
+    const firebase::database::DatabaseReference& location, size_t page_size,
+    const std::function<bool(const firebase::database::DataSnapshot&)>&
+        callback);
+
+#endif  // FIREBASE_TESTAPP_PAGINATED_READER_H_  // NOLINT
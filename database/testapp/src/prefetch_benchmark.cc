@@ -0,0 +1,170 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"        // NOLINT
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "firebase/variant.h"
+#include "prefetch_planner.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kPollMs = 1;
+const int kChildrenPerTarget = 16;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string TargetName(int index) {
+  char name[32];
+  snprintf(name, sizeof(name), "target_%04d", index);
+  return name;
+}
+
+// Waits for future, returning false if it failed.
+bool Wait(const firebase::FutureBase& future) {
+  while (future.status() == firebase::kFutureStatusPending) {
+    ProcessEvents(kPollMs);
+  }
+  return future.status() == firebase::kFutureStatusComplete &&
+         future.error() == firebase::database::kErrorNone;
+}
+
+// Returns the targets to read, skewed towards the lower numbered ones the way
+// a few screens account for most of what players look at.
+std::vector<int> ReadSequence(int num_targets, int num_reads) {
+  std::vector<double> weights;
+  for (int i = 0; i < num_targets; i++) weights.push_back(1.0 / (i + 1));
+  std::discrete_distribution<int> distribution(weights.begin(), weights.end());
+  std::minstd_rand random(1);
+  std::vector<int> sequence;
+  for (int i = 0; i < num_reads; i++) sequence.push_back(distribution(random));
+  return sequence;
+}
+
+}  // namespace
+
+bool RunPrefetchBenchmark(firebase::database::Database* database, int argc,
+                          const char* argv[]) {
+  int num_targets = 20;
+  int target_bytes = 16 * 1024;
+  int num_reads = 200;
+  const char* targets_arg = GetArgument(argc, argv, "benchmark_targets");
+  if (targets_arg) num_targets = atoi(targets_arg);
+  const char* bytes_arg = GetArgument(argc, argv, "benchmark_target_bytes");
+  if (bytes_arg) target_bytes = atoi(bytes_arg);
+  const char* reads_arg = GetArgument(argc, argv, "benchmark_reads");
+  if (reads_arg) num_reads = atoi(reads_arg);
+  if (num_targets <= 0 || target_bytes <= 0 || num_reads <= 0) {
+    LogMessage("ERROR: --benchmark_targets, --benchmark_target_bytes and "
+               "--benchmark_reads must be positive.");
+    return false;
+  }
+  // By default only about half of the targets fit.
+  size_t budget_bytes = static_cast<size_t>(num_targets) * target_bytes / 2;
+  const char* budget_arg = GetArgument(argc, argv, "benchmark_budget_bytes");
+  if (budget_arg) budget_bytes = strtoul(budget_arg, nullptr, 10);
+  LogMessage(
+      "Benchmarking prefetching with %d targets of %d bytes, a %.1f MB "
+      "budget and %d reads.",
+      num_targets, target_bytes, budget_bytes / (1024.0 * 1024.0), num_reads);
+
+  firebase::database::DatabaseReference location =
+      database->GetReference("benchmarks").PushChild();
+  std::map<std::string, firebase::Variant> data;
+  std::string payload(target_bytes / kChildrenPerTarget, 'x');
+  for (int i = 0; i < num_targets; i++) {
+    for (int j = 0; j < kChildrenPerTarget; j++) {
+      data[TargetName(i) + "/child_" + std::to_string(j)] = payload;
+    }
+  }
+  if (!Wait(location.UpdateChildren(data))) {
+    LogMessage("ERROR: Unable to write the benchmark data.");
+    return false;
+  }
+  std::vector<int> sequence = ReadSequence(num_targets, num_reads);
+
+  // Read without prefetching.
+  std::vector<double> cold;
+  bool success = true;
+  for (size_t i = 0; i < sequence.size(); i++) {
+    Clock::time_point start = Clock::now();
+    success = Wait(location.Child(TargetName(sequence[i])).GetValue()) &&
+              success;
+    cold.push_back(SecondsSince(start));
+  }
+  LogLatencies("Without prefetching", cold);
+
+  // Prefetch every target, the most popular last so that it's the most
+  // recently used, then read the same sequence again.
+  {
+    PrefetchPlanner planner(budget_bytes);
+    Clock::time_point start = Clock::now();
+    for (int i = num_targets - 1; i >= 0; i--) {
+      planner.Prefetch(location.Child(TargetName(i)));
+    }
+    while (planner.warming()) {
+      planner.Poll();
+      ProcessEvents(kPollMs);
+    }
+    planner.Poll();
+    LogMessage(
+        "  Prefetched in %.2f s: %d targets (%.1f MB) kept synced, %d "
+        "evicted.",
+        SecondsSince(start), static_cast<int>(planner.size()),
+        planner.stats().synced_bytes / (1024.0 * 1024.0),
+        static_cast<int>(planner.stats().evictions));
+
+    std::vector<double> hits;
+    std::vector<double> misses;
+    for (size_t i = 0; i < sequence.size(); i++) {
+      size_t hits_before = planner.stats().hits;
+      Clock::time_point read_start = Clock::now();
+      success =
+          Wait(planner.GetValue(location.Child(TargetName(sequence[i])))) &&
+          success;
+      double seconds = SecondsSince(read_start);
+      if (planner.stats().hits > hits_before) {
+        hits.push_back(seconds);
+      } else {
+        misses.push_back(seconds);
+      }
+      planner.Poll();
+    }
+    LogMessage("  Hit rate: %.1f%% (%d hits, %d misses).",
+               100.0 * hits.size() / sequence.size(),
+               static_cast<int>(hits.size()), static_cast<int>(misses.size()));
+    LogLatencies("Prefetched hits", hits);
+    LogLatencies("Prefetched misses", misses);
+  }
+
+  success = Wait(location.RemoveValue()) && success;
+  LogMessage(success ? "SUCCESS: Prefetch benchmark complete."
+                     : "ERROR: Prefetch benchmark failed.");
+  return success;
+}
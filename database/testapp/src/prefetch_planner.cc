@@ -0,0 +1,120 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "prefetch_planner.h"  // NOLINT
+
+#include "variant_json.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+PrefetchPlanner::PrefetchPlanner(size_t budget_bytes)
+    : budget_bytes_(budget_bytes) {}
+
+PrefetchPlanner::~PrefetchPlanner() { Clear(); }
+
+std::string PrefetchPlanner::TargetKey(
+    const firebase::database::DatabaseReference& location,
+    const QuerySpec& spec) {
+  return location.url() + "?" + spec.Key();
+}
+
+void PrefetchPlanner::Prefetch(
+    const firebase::database::DatabaseReference& location,
+    const QuerySpec& spec) {
+  std::string key = TargetKey(location, spec);
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    targets_.splice(targets_.begin(), targets_, found->second);
+    return;
+  }
+  targets_.push_front(Target());
+  Target& target = targets_.front();
+  target.key = key;
+  target.query = spec.Apply(location);
+  target.query.SetKeepSynchronized(true);
+  target.first_read = target.query.GetValue();
+  target.synced = false;
+  target.bytes = 0;
+  index_[key] = targets_.begin();
+}
+
+firebase::Future<firebase::database::DataSnapshot> PrefetchPlanner::GetValue(
+    const firebase::database::DatabaseReference& location,
+    const QuerySpec& spec) {
+  auto found = index_.find(TargetKey(location, spec));
+  if (found == index_.end()) {
+    stats_.misses++;
+    return spec.Apply(location).GetValue();
+  }
+  Target& target = *found->second;
+  if (target.synced) {
+    stats_.hits++;
+  } else {
+    stats_.misses++;
+  }
+  targets_.splice(targets_.begin(), targets_, found->second);
+  return target.query.GetValue();
+}
+
+void PrefetchPlanner::Poll() {
+  for (TargetIterator it = targets_.begin(); it != targets_.end();) {
+    TargetIterator target = it++;
+    if (target->synced ||
+        target->first_read.status() == firebase::kFutureStatusPending) {
+      continue;
+    }
+    if (target->first_read.error() != firebase::database::kErrorNone) {
+      LogMessage("ERROR: Prefetching %s failed with error %d: %s",
+                 target->key.c_str(), target->first_read.error(),
+                 target->first_read.error_message());
+      Evict(target);
+      continue;
+    }
+    target->synced = true;
+    target->bytes = VariantToJson(target->first_read.result()->value()).size();
+    target->first_read.Release();
+    stats_.synced_bytes += target->bytes;
+  }
+
+  // Evict the least recently used targets, skipping those that are still
+  // being fetched since their size isn't known yet.
+  while (stats_.synced_bytes > budget_bytes_) {
+    TargetIterator victim = targets_.end();
+    for (TargetIterator it = targets_.begin(); it != targets_.end(); ++it) {
+      if (it->synced) victim = it;
+    }
+    if (victim == targets_.end()) break;
+    Evict(victim);
+    stats_.evictions++;
+  }
+}
+
+void PrefetchPlanner::Clear() {
+  while (!targets_.empty()) Evict(targets_.begin());
+}
+
+bool PrefetchPlanner::warming() const {
+  for (auto it = targets_.begin(); it != targets_.end(); ++it) {
+    if (!it->synced) return true;
+  }
+  return false;
+}
+
+void PrefetchPlanner::Evict(TargetIterator target) {
+  target->query.SetKeepSynchronized(false);
+  if (target->synced) stats_.synced_bytes -= target->bytes;
+  index_.erase(target->key);
+  targets_.erase(target);
+}
@@ -0,0 +1,113 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_PREFETCH_PLANNER_H_  // NOLINT
+#define FIREBASE_TESTAPP_PREFETCH_PLANNER_H_  // NOLINT
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "query_cache.h"  // NOLINT
+
+// Counters describing how effective a PrefetchPlanner has been.
+struct PrefetchStats {
+  PrefetchStats() : hits(0), misses(0), evictions(0), synced_bytes(0) {}
+  // GetValue() calls for a target that was already synced, which the client
+  // can answer from its local copy.
+  size_t hits;
+  // GetValue() calls for a target that wasn't declared, was evicted or was
+  // still being fetched.
+  size_t misses;
+  // Targets that stopped being kept synced to stay within the budget.
+  size_t evictions;
+  // Estimated size of the data currently kept synced.
+  size_t synced_bytes;
+};
+
+// Keeps a declared set of hot locations and queries synced ahead of time, so
+// that reading them later doesn't wait on the network, e.g. to warm the data
+// a screen needs before the player gets there:
+//
+//   PrefetchPlanner planner(4 * 1024 * 1024);
+//   planner.Prefetch(database->GetReference("leaderboard"),
+//                    QuerySpec().OrderByChild("score").LimitToLast(100));
+//   ...
+//   planner.Poll();  // regularly
+//   ...
+//   auto future = planner.GetValue(database->GetReference("leaderboard"),
+//                                  QuerySpec().OrderByChild("score")
+//                                      .LimitToLast(100));
+//
+// Each target is kept synced with SetKeepSynchronized(true), and its size is
+// estimated from the JSON encoding of its data once the first copy arrives.
+// When the synced data goes over the budget, the least recently used targets
+// stop being synced until it fits again.
+//
+// The planner isn't thread-safe, and must be destroyed before the Database.
+class PrefetchPlanner {
+ public:
+  explicit PrefetchPlanner(size_t budget_bytes);
+  ~PrefetchPlanner();
+
+  // Starts keeping the data selected by spec at location synced, or marks it
+  // as recently used if it already is.
+  void Prefetch(const firebase::database::DatabaseReference& location,
+                const QuerySpec& spec = QuerySpec());
+  // Reads the data selected by spec at location, counting a hit if the
+  // planner already had it synced.
+  firebase::Future<firebase::database::DataSnapshot> GetValue(
+      const firebase::database::DatabaseReference& location,
+      const QuerySpec& spec = QuerySpec());
+  // Records the size of targets whose data has arrived, and evicts targets
+  // until the synced data fits in the budget.
+  void Poll();
+  // Stops keeping every target synced.
+  void Clear();
+
+  // Number of targets being kept synced, including those still being
+  // fetched.
+  size_t size() const { return targets_.size(); }
+  // Whether any target is still being fetched for the first time.
+  bool warming() const;
+  const PrefetchStats& stats() const { return stats_; }
+
+ private:
+  struct Target {
+    std::string key;
+    firebase::database::Query query;
+    // The first read of the target, used to tell when it's synced and how
+    // big it is.
+    firebase::Future<firebase::database::DataSnapshot> first_read;
+    bool synced;
+    size_t bytes;
+  };
+  typedef std::list<Target>::iterator TargetIterator;
+
+  static std::string TargetKey(
+      const firebase::database::DatabaseReference& location,
+      const QuerySpec& spec);
+  void Evict(TargetIterator target);
+
+  size_t budget_bytes_;
+  // Most recently used first.
+  std::list<Target> targets_;
+  std::map<std::string, TargetIterator> index_;
+  PrefetchStats stats_;
+};
+
+#endif  // FIREBASE_TESTAPP_PREFETCH_PLANNER_H_  // NOLINT
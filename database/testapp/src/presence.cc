@@ -0,0 +1,121 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "presence.h"  // NOLINT
+
+#include <map>
+
+#include "firebase/variant.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+Presence::Presence(const firebase::database::DatabaseReference& root,
+                   const std::string& user_id)
+    : user_(root.Child(user_id)),
+      connected_(root.database()->GetReference(".info/connected")),
+      user_id_(user_id),
+      started_(false),
+      is_connected_(false),
+      generation_(0),
+      registered_generation_(0),
+      online_(false),
+      registration_seconds_(-1),
+      error_(firebase::database::kErrorNone) {}
+
+Presence::~Presence() {
+  if (started_) connected_.RemoveValueListener(this);
+}
+
+void Presence::Start() {
+  if (started_) return;
+  started_ = true;
+  connected_.AddValueListener(this);
+}
+
+firebase::Future<void> Presence::Stop() {
+  if (started_) {
+    connected_.RemoveValueListener(this);
+    started_ = false;
+  }
+  online_ = false;
+  if (!connection_.is_valid()) return firebase::Future<void>();
+  connection_.OnDisconnect()->Cancel();
+  firebase::Future<void> removed = connection_.RemoveValue();
+  connection_ = firebase::database::DatabaseReference();
+  return removed;
+}
+
+void Presence::Poll() {
+  bool is_connected;
+  int generation;
+  Clock::time_point connected_time;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_connected = is_connected_;
+    generation = generation_;
+    connected_time = connected_time_;
+  }
+  if (!is_connected) {
+    online_ = false;
+    return;
+  }
+
+  if (registered_generation_ != generation) {
+    // A new connection. The OnDisconnect() removal is sent first, so that the
+    // node can't outlive the connection even if it drops straight away.
+    registered_generation_ = generation;
+    online_ = false;
+    registration_seconds_ = -1;
+    connection_ = user_.PushChild();
+    on_disconnect_future_ = connection_.OnDisconnect()->RemoveValue();
+    std::map<std::string, firebase::Variant> node;
+    node["connected_at"] = firebase::database::ServerTimestamp();
+    set_future_ = connection_.SetValue(node);
+  }
+
+  if (!online_ &&
+      on_disconnect_future_.status() == firebase::kFutureStatusComplete &&
+      set_future_.status() == firebase::kFutureStatusComplete) {
+    if (on_disconnect_future_.error() != firebase::database::kErrorNone ||
+        set_future_.error() != firebase::database::kErrorNone) {
+      error_ = static_cast<firebase::database::Error>(
+          on_disconnect_future_.error() != firebase::database::kErrorNone
+              ? on_disconnect_future_.error()
+              : set_future_.error());
+      return;
+    }
+    online_ = true;
+    registration_seconds_ =
+        std::chrono::duration<double>(Clock::now() - connected_time).count();
+  }
+}
+
+void Presence::OnValueChanged(
+    const firebase::database::DataSnapshot& snapshot) {
+  bool is_connected = snapshot.value().is_bool() &&
+                      snapshot.value().bool_value();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_connected && !is_connected_) {
+    generation_++;
+    connected_time_ = Clock::now();
+  }
+  is_connected_ = is_connected;
+}
+
+void Presence::OnCancelled(const firebase::database::Error& error,
+                           const char* error_message) {
+  LogMessage("ERROR: Presence of %s canceled: %d: %s", user_id_.c_str(), error,
+             error_message);
+}
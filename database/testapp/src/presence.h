@@ -0,0 +1,92 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_PRESENCE_H_  // NOLINT
+#define FIREBASE_TESTAPP_PRESENCE_H_  // NOLINT
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "firebase/database.h"
+#include "firebase/future.h"
+
+// Publishes whether a user is connected, with one node per connection so that
+// a user connected from several clients stays online until the last of them
+// goes away:
+//
+//   <root>/<user_id>/<connection_id>: { connected_at: <server timestamp> }
+//
+// Each time the client connects, an OnDisconnect() removal of a new
+// connection node is registered and then the node is written. However the
+// client goes away, the server removes the node, and the user's node goes
+// with their last connection.
+//
+// The connection state is reported on a database thread, but all writes are
+// made from Poll(), which must be called regularly.
+class Presence : public firebase::database::ValueListener {
+ public:
+  Presence(const firebase::database::DatabaseReference& root,
+           const std::string& user_id);
+  ~Presence() override;
+
+  // Starts watching the connection state.
+  void Start();
+  // Stops watching the connection state, cancels the OnDisconnect() removal
+  // and removes the connection node. Returns the future of the removal.
+  firebase::Future<void> Stop();
+  // Registers the current connection if it hasn't been yet, and checks on the
+  // registration in progress.
+  void Poll();
+
+  const std::string& user_id() const { return user_id_; }
+  // Whether the current connection's node has been written.
+  bool online() const { return online_; }
+  // Time between the client connecting and its connection node being
+  // written, for the latest connection, or -1 if it hasn't been yet.
+  double registration_seconds() const { return registration_seconds_; }
+  // Whether a registration failed, and how.
+  firebase::database::Error error() const { return error_; }
+
+  void OnValueChanged(const firebase::database::DataSnapshot& snapshot)
+      override;
+  void OnCancelled(const firebase::database::Error& error,
+                   const char* error_message) override;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  firebase::database::DatabaseReference user_;
+  firebase::database::DatabaseReference connected_;
+  std::string user_id_;
+  bool started_;
+
+  // Written by OnValueChanged().
+  std::mutex mutex_;
+  bool is_connected_;
+  // Incremented for each connection.
+  int generation_;
+  Clock::time_point connected_time_;
+
+  // The registration of connection number registered_generation_.
+  int registered_generation_;
+  firebase::database::DatabaseReference connection_;
+  firebase::Future<void> on_disconnect_future_;
+  firebase::Future<void> set_future_;
+  bool online_;
+  double registration_seconds_;
+  firebase::database::Error error_;
+};
+
+#endif  // FIREBASE_TESTAPP_PRESENCE_H_  // NOLINT
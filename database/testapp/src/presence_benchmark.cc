@@ -0,0 +1,230 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"     // NOLINT
+#include "firebase/app.h"
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "presence.h"       // NOLINT
+#include "process_stats.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int kPollMs = 10;
+// How long to wait for every client to come online, or to be cleaned up.
+const int kTimeoutSeconds = 120;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// A client with its own App, and so its own connection to the database.
+struct SimulatedClient {
+  SimulatedClient() : app(nullptr), database(nullptr), presence(nullptr) {}
+
+  firebase::App* app;
+  firebase::database::Database* database;
+  Presence* presence;
+  Clock::time_point disconnect_time;
+};
+
+// Watches the presence root from the main client, and records when each user
+// appears and disappears.
+class PresenceObserver : public firebase::database::ChildListener {
+ public:
+  void OnChildAdded(const firebase::database::DataSnapshot& snapshot,
+                    const char*) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    online_[snapshot.key_string()] = Clock::now();
+  }
+  void OnChildChanged(const firebase::database::DataSnapshot&,
+                      const char*) override {}
+  void OnChildMoved(const firebase::database::DataSnapshot&,
+                    const char*) override {}
+  void OnChildRemoved(
+      const firebase::database::DataSnapshot& snapshot) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    offline_[snapshot.key_string()] = Clock::now();
+  }
+  void OnCancelled(const firebase::database::Error& error,
+                   const char* error_message) override {
+    LogMessage("ERROR: Presence observer canceled: %d: %s", error,
+               error_message);
+  }
+
+  size_t online_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return online_.size();
+  }
+  size_t offline_count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return offline_.size();
+  }
+  // Returns when user_id was seen to go offline, if it was.
+  bool offline_time(const std::string& user_id, Clock::time_point* time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = offline_.find(user_id);
+    if (it == offline_.end()) return false;
+    *time = it->second;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, Clock::time_point> online_;
+  std::map<std::string, Clock::time_point> offline_;
+};
+
+}  // namespace
+
+bool RunPresenceBenchmark(firebase::database::Database* database, int argc,
+                          const char* argv[]) {
+  int num_clients = 100;
+  const char* clients_arg = GetArgument(argc, argv, "benchmark_clients");
+  if (clients_arg) num_clients = atoi(clients_arg);
+  if (num_clients <= 0) {
+    LogMessage("ERROR: --benchmark_clients must be positive.");
+    return false;
+  }
+  LogMessage("Benchmarking presence with %d simulated clients.", num_clients);
+
+  firebase::database::DatabaseReference root =
+      database->GetReference("benchmarks").PushChild();
+  std::string root_path = "benchmarks/" + root.key_string();
+  PresenceObserver observer;
+  root.AddChildListener(&observer);
+
+  // Connect every client and register its presence.
+  int64_t memory_baseline = GetResidentMemoryBytes();
+  std::vector<SimulatedClient> clients(num_clients);
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < num_clients; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "presence_client_%d", i);
+    SimulatedClient& client = clients[i];
+#if defined(__ANDROID__)
+    client.app = firebase::App::Create(database->app()->options(), name,
+                                       GetJniEnv(), GetActivity());
+#else
+    client.app = firebase::App::Create(database->app()->options(), name);
+#endif  // defined(__ANDROID__)
+    client.database =
+        firebase::database::Database::GetInstance(client.app, database->url());
+    if (!client.database) {
+      LogMessage("ERROR: Unable to create database client %d.", i);
+      continue;
+    }
+    client.database->set_persistence_enabled(false);
+    client.presence = new Presence(
+        client.database->GetReference(root_path.c_str()), name);
+    client.presence->Start();
+  }
+  double create_seconds = SecondsSince(start);
+
+  int online = 0;
+  int failed = 0;
+  while (online + failed < num_clients &&
+         SecondsSince(start) < kTimeoutSeconds) {
+    online = 0;
+    failed = 0;
+    for (size_t i = 0; i < clients.size(); i++) {
+      Presence* presence = clients[i].presence;
+      if (!presence) {
+        failed++;
+        continue;
+      }
+      presence->Poll();
+      if (presence->online()) online++;
+      if (presence->error() != firebase::database::kErrorNone) failed++;
+    }
+    if (ProcessEvents(kPollMs)) break;
+  }
+  double online_seconds = SecondsSince(start);
+  int64_t memory = GetResidentMemoryBytes();
+  std::vector<double> registration;
+  for (size_t i = 0; i < clients.size(); i++) {
+    if (clients[i].presence && clients[i].presence->online()) {
+      registration.push_back(clients[i].presence->registration_seconds());
+    }
+  }
+  LogMessage(
+      "  %d clients created in %.2f s, %d online after %.2f s, %d failed.",
+      num_clients, create_seconds, online, online_seconds, failed);
+  LogLatencies("Registration", registration);
+  if (memory >= 0 && memory_baseline >= 0) {
+    LogMessage("  Memory: %.1f KB per client.",
+               (memory - memory_baseline) / 1024.0 / num_clients);
+  }
+
+  // Let the observer catch up, then disconnect every client and time how
+  // long the server takes to clean up after each.
+  start = Clock::now();
+  while (observer.online_count() < static_cast<size_t>(online) &&
+         SecondsSince(start) < kTimeoutSeconds) {
+    if (ProcessEvents(kPollMs)) break;
+  }
+  LogMessage("  The observer saw %d users online.",
+             static_cast<int>(observer.online_count()));
+  for (size_t i = 0; i < clients.size(); i++) {
+    if (!clients[i].presence || !clients[i].presence->online()) continue;
+    clients[i].disconnect_time = Clock::now();
+    clients[i].database->GoOffline();
+  }
+  start = Clock::now();
+  while (observer.offline_count() < observer.online_count() &&
+         SecondsSince(start) < kTimeoutSeconds) {
+    if (ProcessEvents(kPollMs)) break;
+  }
+  std::vector<double> cleanup;
+  for (size_t i = 0; i < clients.size(); i++) {
+    Clock::time_point offline_time;
+    if (clients[i].presence && clients[i].presence->online() &&
+        observer.offline_time(clients[i].presence->user_id(),
+                              &offline_time)) {
+      cleanup.push_back(std::chrono::duration<double>(
+                            offline_time - clients[i].disconnect_time)
+                            .count());
+    }
+  }
+  LogLatencies("Disconnect to cleanup", cleanup);
+  bool success = online == num_clients &&
+                 cleanup.size() == static_cast<size_t>(num_clients);
+
+  root.RemoveChildListener(&observer);
+  for (size_t i = 0; i < clients.size(); i++) {
+    delete clients[i].presence;
+    delete clients[i].database;
+    delete clients[i].app;
+  }
+  firebase::Future<void> removed = root.RemoveValue();
+  while (removed.status() == firebase::kFutureStatusPending) {
+    ProcessEvents(kPollMs);
+  }
+  LogMessage(success ? "SUCCESS: Presence benchmark complete."
+                     : "ERROR: Presence benchmark failed.");
+  return success;
+}
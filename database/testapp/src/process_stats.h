@@ -0,0 +1,29 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_PROCESS_STATS_H_  // NOLINT
+#define FIREBASE_TESTAPP_PROCESS_STATS_H_  // NOLINT
+
+#include <cstdint>
+
+// Measurements of the testapp process used by the benchmarks. Each returns -1
+// where it isn't supported.
+
+// Returns the resident memory of this process, in bytes.
+int64_t GetResidentMemoryBytes();
+
+// Returns the total size of the regular files under path, in bytes.
+int64_t GetDirectorySize(const char* path);
+
+#endif  // FIREBASE_TESTAPP_PROCESS_STATS_H_  // NOLINT
@@ -0,0 +1,454 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query_cache.h"  // NOLINT
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "local_index.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+// Appends an unambiguous encoding of a query bound to key. The database
+// compares numbers by value, so integral doubles are encoded as integers.
+void AppendVariantKey(const firebase::Variant& value, std::string* key) {
+  char buffer[32];
+  if (value.is_null()) {
+    key->append("n");
+  } else if (value.is_bool()) {
+    key->append(value.bool_value() ? "b1" : "b0");
+  } else if (value.is_int64() ||
+             (value.is_double() &&
+              value.double_value() == std::floor(value.double_value()) &&
+              std::fabs(value.double_value()) < 9.0e15)) {
+    snprintf(buffer, sizeof(buffer), "i%lld",
+             static_cast<long long>(value.AsInt64().int64_value()));  // NOLINT
+    key->append(buffer);
+  } else if (value.is_double()) {
+    snprintf(buffer, sizeof(buffer), "d%.17g", value.double_value());
+    key->append(buffer);
+  } else {
+    std::string text = value.AsString().string_value();
+    snprintf(buffer, sizeof(buffer), "s%zu:", text.size());
+    key->append(buffer);
+    key->append(text);
+  }
+}
+
+void AppendSizeKey(const char* name, size_t value, std::string* key) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%s%zu", name, value);
+  key->append(buffer);
+}
+
+// Parses a key that the database orders as a number: a 32-bit integer
+// written without leading zeros.
+bool ParseIntegerKey(const std::string& key, int64_t* value) {
+  bool negative = !key.empty() && key[0] == '-';
+  const char* digits = key.c_str() + (negative ? 1 : 0);
+  // Neither a lone sign, leading zeros nor "-0".
+  if (!*digits || (digits[0] == '0' && (digits[1] || negative))) return false;
+  for (const char* c = digits; *c; c++) {
+    if (*c < '0' || *c > '9') return false;
+  }
+  errno = 0;
+  long long parsed = strtoll(key.c_str(), nullptr, 10);  // NOLINT
+  if (errno || parsed < INT32_MIN || parsed > INT32_MAX) return false;
+  *value = parsed;
+  return true;
+}
+
+// Orders keys the way the database does: integer keys first, by value, then
+// the others as strings.
+int CompareKeys(const std::string& a, const std::string& b) {
+  int64_t x = 0;
+  int64_t y = 0;
+  bool a_integer = ParseIntegerKey(a, &x);
+  bool b_integer = ParseIntegerKey(b, &y);
+  if (a_integer && b_integer) return x < y ? -1 : x > y ? 1 : 0;
+  if (a_integer != b_integer) return a_integer ? -1 : 1;
+  return a.compare(b);
+}
+
+}  // namespace
+
+QuerySpec::QuerySpec()
+    : order_by_(kOrderByDefault), limit_first_(0), limit_last_(0) {}
+
+QuerySpec QuerySpec::OrderByChild(const std::string& path) const {
+  QuerySpec spec(*this);
+  spec.order_by_ = kOrderByChild;
+  spec.order_by_child_ = path;
+  return spec;
+}
+
+QuerySpec QuerySpec::OrderByKey() const {
+  QuerySpec spec(*this);
+  spec.order_by_ = kOrderByKey;
+  return spec;
+}
+
+QuerySpec QuerySpec::OrderByPriority() const {
+  QuerySpec spec(*this);
+  spec.order_by_ = kOrderByPriority;
+  return spec;
+}
+
+QuerySpec QuerySpec::OrderByValue() const {
+  QuerySpec spec(*this);
+  spec.order_by_ = kOrderByValue;
+  return spec;
+}
+
+QuerySpec QuerySpec::StartAt(const firebase::Variant& value) const {
+  return StartAt(value, std::string());
+}
+
+QuerySpec QuerySpec::StartAt(const firebase::Variant& value,
+                             const std::string& child_key) const {
+  QuerySpec spec(*this);
+  spec.start_.set = true;
+  spec.start_.value = value;
+  spec.start_.child_key = child_key;
+  return spec;
+}
+
+QuerySpec QuerySpec::EndAt(const firebase::Variant& value) const {
+  return EndAt(value, std::string());
+}
+
+QuerySpec QuerySpec::EndAt(const firebase::Variant& value,
+                           const std::string& child_key) const {
+  QuerySpec spec(*this);
+  spec.end_.set = true;
+  spec.end_.value = value;
+  spec.end_.child_key = child_key;
+  return spec;
+}
+
+QuerySpec QuerySpec::EqualTo(const firebase::Variant& value) const {
+  return EqualTo(value, std::string());
+}
+
+QuerySpec QuerySpec::EqualTo(const firebase::Variant& value,
+                             const std::string& child_key) const {
+  return StartAt(value, child_key).EndAt(value, child_key);
+}
+
+QuerySpec QuerySpec::LimitToFirst(size_t limit) const {
+  QuerySpec spec(*this);
+  spec.limit_first_ = limit;
+  spec.limit_last_ = 0;
+  return spec;
+}
+
+QuerySpec QuerySpec::LimitToLast(size_t limit) const {
+  QuerySpec spec(*this);
+  spec.limit_last_ = limit;
+  spec.limit_first_ = 0;
+  return spec;
+}
+
+std::string QuerySpec::Key() const {
+  std::string key;
+  bool filtered = start_.set || end_.set || limit_first_ || limit_last_;
+  // Without filters or limits, the ordering doesn't change which data is
+  // returned.
+  if (!filtered) return key;
+
+  switch (order_by_) {
+    case kOrderByDefault:
+    case kOrderByPriority:
+      // Priority is the default ordering.
+      key.append("p");
+      break;
+    case kOrderByChild:
+      AppendSizeKey("c", order_by_child_.size(), &key);
+      key.append(":");
+      key.append(order_by_child_);
+      break;
+    case kOrderByKey:
+      key.append("k");
+      break;
+    case kOrderByValue:
+      key.append("v");
+      break;
+  }
+  if (start_.set) {
+    key.append("|>");
+    AppendVariantKey(start_.value, &key);
+    AppendVariantKey(firebase::Variant(start_.child_key), &key);
+  }
+  if (end_.set) {
+    key.append("|<");
+    AppendVariantKey(end_.value, &key);
+    AppendVariantKey(firebase::Variant(end_.child_key), &key);
+  }
+  if (limit_first_) {
+    key.append("|");
+    AppendSizeKey("f", limit_first_, &key);
+  }
+  if (limit_last_) {
+    key.append("|");
+    AppendSizeKey("l", limit_last_, &key);
+  }
+  return key;
+}
+
+firebase::database::Query QuerySpec::Apply(
+    const firebase::database::DatabaseReference& location) const {
+  firebase::database::Query query = location;
+  switch (order_by_) {
+    case kOrderByDefault:
+      break;
+    case kOrderByChild:
+      query = query.OrderByChild(order_by_child_.c_str());
+      break;
+    case kOrderByKey:
+      query = query.OrderByKey();
+      break;
+    case kOrderByPriority:
+      query = query.OrderByPriority();
+      break;
+    case kOrderByValue:
+      query = query.OrderByValue();
+      break;
+  }
+  if (start_.set && end_.set && start_.value == end_.value &&
+      start_.child_key == end_.child_key) {
+    query = start_.child_key.empty()
+                ? query.EqualTo(start_.value)
+                : query.EqualTo(start_.value, start_.child_key.c_str());
+  } else {
+    if (start_.set) {
+      query = start_.child_key.empty()
+                  ? query.StartAt(start_.value)
+                  : query.StartAt(start_.value, start_.child_key.c_str());
+    }
+    if (end_.set) {
+      query = end_.child_key.empty()
+                  ? query.EndAt(end_.value)
+                  : query.EndAt(end_.value, end_.child_key.c_str());
+    }
+  }
+  if (limit_first_) query = query.LimitToFirst(limit_first_);
+  if (limit_last_) query = query.LimitToLast(limit_last_);
+  return query;
+}
+
+bool QuerySpec::InRange(const firebase::database::DataSnapshot& child) const {
+  firebase::Variant value = SortValue(child);
+  std::string key = child.key_string();
+  if (start_.set && CompareToBound(value, key, start_) < 0) return false;
+  if (end_.set && CompareToBound(value, key, end_) > 0) return false;
+  return true;
+}
+
+int QuerySpec::CompareChildren(
+    const firebase::database::DataSnapshot& a,
+    const firebase::database::DataSnapshot& b) const {
+  int order = CompareSortValues(SortValue(a), SortValue(b));
+  return order != 0 ? order : CompareKeys(a.key_string(), b.key_string());
+}
+
+firebase::Variant QuerySpec::SortValue(
+    const firebase::database::DataSnapshot& child) const {
+  switch (order_by_) {
+    case kOrderByChild:
+      return child.Child(order_by_child_).value();
+    case kOrderByKey:
+      return firebase::Variant(child.key_string());
+    case kOrderByValue:
+      return child.value();
+    case kOrderByDefault:
+    case kOrderByPriority:
+      break;
+  }
+  return child.priority();
+}
+
+int QuerySpec::CompareSortValues(const firebase::Variant& a,
+                                 const firebase::Variant& b) const {
+  if (order_by_ == kOrderByKey) {
+    return CompareKeys(a.AsString().string_value(),
+                       b.AsString().string_value());
+  }
+  return CompareDatabaseValues(a, b);
+}
+
+int QuerySpec::CompareToBound(const firebase::Variant& value,
+                              const std::string& key,
+                              const Bound& bound) const {
+  int order = CompareSortValues(value, bound.value);
+  // Without a key, the bound takes in every child with the value.
+  if (order != 0 || bound.child_key.empty()) return order;
+  return CompareKeys(key, bound.child_key);
+}
+
+QueryCache::QueryCache(const firebase::database::DatabaseReference& location)
+    : location_(location), invalidator_(this), generation_(0) {
+  location_.AddChildListener(&invalidator_);
+}
+
+QueryCache::~QueryCache() {
+  location_.RemoveChildListener(&invalidator_);
+  Clear();
+}
+
+firebase::Future<firebase::database::DataSnapshot> QueryCache::GetValue(
+    const QuerySpec& spec) {
+  std::string key = spec.Key();
+  size_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      const firebase::FutureBase& future = it->second.future;
+      if (future.status() == firebase::kFutureStatusPending ||
+          (future.status() == firebase::kFutureStatusComplete &&
+           future.error() == firebase::database::kErrorNone)) {
+        stats_.hits++;
+        return it->second.future;
+      }
+      // Don't hand out failed results, fetch them again instead.
+      entries_.erase(it);
+    }
+    stats_.misses++;
+    generation = generation_;
+  }
+  // Issue the request outside of the lock, as the SDK may call back into the
+  // listener from another thread.
+  firebase::Future<firebase::database::DataSnapshot> future =
+      spec.Apply(location_).GetValue();
+  std::lock_guard<std::mutex> lock(mutex_);
+  // If the data changed while the request was being issued, the request may
+  // predate the change, so return it without caching it.
+  if (generation_ == generation) {
+    Entry& entry = entries_[key];
+    entry.spec = spec;
+    entry.future = future;
+  }
+  return future;
+}
+
+void QueryCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  generation_++;
+  entries_.clear();
+}
+
+size_t QueryCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+QueryCacheStats QueryCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+bool QueryCache::Affects(const Entry& entry, ChildEvent event,
+                         const firebase::database::DataSnapshot& child) {
+  const firebase::FutureBase& future = entry.future;
+  if (future.status() == firebase::kFutureStatusPending) {
+    // The result isn't known yet. An added child, or a removed one, outside
+    // the range can't be part of it, but a changed child's old value isn't
+    // known either.
+    return event == kChildChanged || entry.spec.InRange(child);
+  }
+  if (future.status() != firebase::kFutureStatusComplete ||
+      future.error() != firebase::database::kErrorNone) {
+    return true;
+  }
+  const firebase::database::DataSnapshot& result = *entry.future.result();
+  std::string key = child.key_string();
+  if (result.HasChild(key)) {
+    if (event == kChildRemoved) return true;
+    firebase::database::DataSnapshot cached = result.Child(key);
+    return cached.value() != child.value() ||
+           cached.priority() != child.priority();
+  }
+  // The child isn't part of the result, so it only changes the result by
+  // entering it: its new value has to be in range and, under a limit, sort
+  // inside the window the result fills.
+  if (event == kChildRemoved || !entry.spec.InRange(child)) return false;
+  size_t limit = entry.spec.limit_first() + entry.spec.limit_last();
+  if (!limit || result.children_count() < limit) return true;
+  for (const auto& member : result.children()) {
+    int order = entry.spec.CompareChildren(child, member);
+    if (entry.spec.limit_first() ? order < 0 : order > 0) return true;
+  }
+  return false;
+}
+
+void QueryCache::Update(ChildEvent event,
+                        const firebase::database::DataSnapshot& child) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  generation_++;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (Affects(it->second, event, child)) {
+      stats_.invalidations++;
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void QueryCache::Invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.invalidations += entries_.size();
+  generation_++;
+  entries_.clear();
+}
+
+void QueryCache::Invalidator::OnChildAdded(
+    const firebase::database::DataSnapshot& snapshot,
+    const char* previous_sibling) {
+  cache_->Update(kChildAdded, snapshot);
+}
+
+void QueryCache::Invalidator::OnChildChanged(
+    const firebase::database::DataSnapshot& snapshot,
+    const char* previous_sibling) {
+  cache_->Update(kChildChanged, snapshot);
+}
+
+void QueryCache::Invalidator::OnChildMoved(
+    const firebase::database::DataSnapshot& snapshot,
+    const char* previous_sibling) {
+  // A child moves when its sort value changes, so treat it as a change.
+  cache_->Update(kChildChanged, snapshot);
+}
+
+void QueryCache::Invalidator::OnChildRemoved(
+    const firebase::database::DataSnapshot& snapshot) {
+  cache_->Update(kChildRemoved, snapshot);
+}
+
+void QueryCache::Invalidator::OnCancelled(
+    const firebase::database::Error& error_code, const char* error_message) {
+  LogMessage("ERROR: QueryCache listener canceled: %d: %s", error_code,
+             error_message);
+  // Without the listener nothing keeps the cache current, so stop serving
+  // from it.
+  cache_->Invalidate();
+}
@@ -0,0 +1,193 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_QUERY_CACHE_H_  // NOLINT
+#define FIREBASE_TESTAPP_QUERY_CACHE_H_  // NOLINT
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "firebase/database.h"
+#include "firebase/future.h"
+#include "firebase/variant.h"
+
+// Describes a Query relative to a location, in a form that can be compared.
+// The Query class doesn't expose its parameters, so queries that should be
+// cached are described with a QuerySpec, which mirrors the Query interface,
+// and turned into a real Query with Apply().
+class QuerySpec {
+ public:
+  QuerySpec();
+
+  QuerySpec OrderByChild(const std::string& path) const;
+  QuerySpec OrderByKey() const;
+  QuerySpec OrderByPriority() const;
+  QuerySpec OrderByValue() const;
+  QuerySpec StartAt(const firebase::Variant& value) const;
+  QuerySpec StartAt(const firebase::Variant& value,
+                    const std::string& child_key) const;
+  QuerySpec EndAt(const firebase::Variant& value) const;
+  QuerySpec EndAt(const firebase::Variant& value,
+                  const std::string& child_key) const;
+  QuerySpec EqualTo(const firebase::Variant& value) const;
+  QuerySpec EqualTo(const firebase::Variant& value,
+                    const std::string& child_key) const;
+  QuerySpec LimitToFirst(size_t limit) const;
+  QuerySpec LimitToLast(size_t limit) const;
+
+  // Returns a string that is identical for any two specs which select the
+  // same data, e.g. EqualTo(x) and StartAt(x).EndAt(x), or an ordering with
+  // no filters or limits and no ordering at all.
+  std::string Key() const;
+
+  // Builds the Query described by this spec at the given location.
+  firebase::database::Query Apply(
+      const firebase::database::DatabaseReference& location) const;
+
+  // Whether child, a child of the location, lies between the spec's start
+  // and end. The limits aren't taken into account.
+  bool InRange(const firebase::database::DataSnapshot& child) const;
+
+  // Compares two children of the location in the order the spec sorts them.
+  // Returns a negative number, zero or a positive number.
+  int CompareChildren(const firebase::database::DataSnapshot& a,
+                      const firebase::database::DataSnapshot& b) const;
+
+  size_t limit_first() const { return limit_first_; }
+  size_t limit_last() const { return limit_last_; }
+
+ private:
+  enum OrderBy {
+    kOrderByDefault,
+    kOrderByChild,
+    kOrderByKey,
+    kOrderByPriority,
+    kOrderByValue,
+  };
+
+  struct Bound {
+    Bound() : set(false) {}
+    bool set;
+    firebase::Variant value;
+    std::string child_key;
+  };
+
+  // The value a child is sorted on: its key under OrderByKey().
+  firebase::Variant SortValue(
+      const firebase::database::DataSnapshot& child) const;
+  int CompareSortValues(const firebase::Variant& a,
+                        const firebase::Variant& b) const;
+  // Compares a child, given by its sort value and key, to a bound.
+  int CompareToBound(const firebase::Variant& value, const std::string& key,
+                     const Bound& bound) const;
+
+  OrderBy order_by_;
+  std::string order_by_child_;
+  Bound start_;
+  Bound end_;
+  size_t limit_first_;
+  size_t limit_last_;
+};
+
+// Counters describing how effective a QueryCache has been.
+struct QueryCacheStats {
+  QueryCacheStats() : hits(0), misses(0), invalidations(0) {}
+  // GetValue() calls answered by a result (or a request) that was already in
+  // the cache.
+  size_t hits;
+  // GetValue() calls that had to issue a new request.
+  size_t misses;
+  // Cached results dropped because the data at the location changed.
+  size_t invalidations;
+};
+
+// Caches the results of queries at one database location, so that repeating
+// an identical query doesn't go back to the server.
+//
+// The cache keeps itself current with a ChildListener on the location. A
+// child event drops only the cached results it can change: those that hold
+// the child with a different value, and those whose range, and limit window,
+// its new value falls in. The next GetValue() for those specs is fetched
+// again. The listener first reports the children which already exist, which
+// leaves the results that hold them unchanged. Until a request completes
+// its result isn't known, so any event that may touch its range drops it.
+//
+// Results are held as completed Futures, so the cache must be destroyed (or
+// cleared) before the Database instance that produced them.
+class QueryCache {
+ public:
+  explicit QueryCache(const firebase::database::DatabaseReference& location);
+  ~QueryCache();
+
+  // Returns the result of the query described by spec. If an identical query
+  // has already been issued (and didn't fail), its Future is returned without
+  // contacting the server, even if it's still pending.
+  firebase::Future<firebase::database::DataSnapshot> GetValue(
+      const QuerySpec& spec);
+
+  // Drops all cached results.
+  void Clear();
+
+  size_t size() const;
+  QueryCacheStats stats() const;
+
+ private:
+  class Invalidator : public firebase::database::ChildListener {
+   public:
+    explicit Invalidator(QueryCache* cache) : cache_(cache) {}
+    void OnChildAdded(const firebase::database::DataSnapshot& snapshot,
+                      const char* previous_sibling) override;
+    void OnChildChanged(const firebase::database::DataSnapshot& snapshot,
+                        const char* previous_sibling) override;
+    void OnChildMoved(const firebase::database::DataSnapshot& snapshot,
+                      const char* previous_sibling) override;
+    void OnChildRemoved(
+        const firebase::database::DataSnapshot& snapshot) override;
+    void OnCancelled(const firebase::database::Error& error_code,
+                     const char* error_message) override;
+
+   private:
+    QueryCache* cache_;
+  };
+
+  enum ChildEvent { kChildAdded, kChildChanged, kChildRemoved };
+
+  struct Entry {
+    QuerySpec spec;
+    firebase::Future<firebase::database::DataSnapshot> future;
+  };
+
+  // Whether a child event, with the child's new value (its old one if it was
+  // removed), can change the result of entry.
+  static bool Affects(const Entry& entry, ChildEvent event,
+                      const firebase::database::DataSnapshot& child);
+  // Drops the cached results that a child event can change.
+  void Update(ChildEvent event, const firebase::database::DataSnapshot& child);
+  void Invalidate();
+
+  firebase::database::DatabaseReference location_;
+  Invalidator invalidator_;
+  mutable std::mutex mutex_;
+  // Keyed by QuerySpec::Key().
+  std::map<std::string, Entry> entries_;
+  QueryCacheStats stats_;
+  // Incremented on every child event and whenever the entries are dropped,
+  // so that GetValue() can tell if that happened while it was issuing a
+  // request.
+  size_t generation_;
+};
+
+#endif  // FIREBASE_TESTAPP_QUERY_CACHE_H_  // NOLINT
@@ -0,0 +1,76 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharded_counter.h"  // NOLINT
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "firebase/variant.h"
+
+ShardedCounter::ShardedCounter(
+    const firebase::database::DatabaseReference& location, int num_shards)
+    : location_(location),
+      num_shards_(num_shards > 0 ? num_shards : 1),
+      attempts_(0),
+      random_(static_cast<std::minstd_rand::result_type>(
+          std::chrono::steady_clock::now().time_since_epoch().count())) {}
+
+firebase::Future<firebase::database::DataSnapshot> ShardedCounter::Increment(
+    int64_t delta) {
+  int shard;
+  {
+    std::lock_guard<std::mutex> lock(random_mutex_);
+    shard = static_cast<int>(random_() % num_shards_);
+  }
+  return IncrementShard(shard, delta);
+}
+
+firebase::Future<firebase::database::DataSnapshot> ShardedCounter::Increment(
+    int64_t delta, const std::string& key) {
+  return IncrementShard(
+      static_cast<int>(std::hash<std::string>()(key) % num_shards_), delta);
+}
+
+firebase::Future<firebase::database::DataSnapshot> ShardedCounter::Read() {
+  return location_.GetValue();
+}
+
+int64_t ShardedCounter::Sum(const firebase::database::DataSnapshot& snapshot) {
+  int64_t total = 0;
+  std::vector<firebase::database::DataSnapshot> shards = snapshot.children();
+  for (size_t i = 0; i < shards.size(); i++) {
+    total += shards[i].value().AsInt64().int64_value();
+  }
+  return total;
+}
+
+firebase::Future<firebase::database::DataSnapshot>
+ShardedCounter::IncrementShard(int shard, int64_t delta) {
+  std::string name = "shard_" + std::to_string(shard);
+  return location_.Child(name).RunTransaction(
+      [this, delta](firebase::database::MutableData* data) {
+        attempts_++;
+        // The shard is null until its first increment. The function may also
+        // first run against a locally cached null value, before the server's
+        // value is known, in which case the write is rejected and it runs
+        // again.
+        int64_t value = data->value().is_null()
+                            ? 0
+                            : data->value().AsInt64().int64_value();
+        data->set_value(value + delta);
+        return firebase::database::kTransactionResultSuccess;
+      });
+}
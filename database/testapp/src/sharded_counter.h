@@ -0,0 +1,74 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_SHARDED_COUNTER_H_  // NOLINT
+#define FIREBASE_TESTAPP_SHARDED_COUNTER_H_  // NOLINT
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "firebase/database.h"
+#include "firebase/future.h"
+
+// A counter that spreads its increments across several child shards, so that
+// concurrent increments usually run their transactions on different nodes and
+// don't have to be retried because of each other:
+//
+//   counter/
+//     shard_0: 12
+//     shard_1: 9
+//     ...
+//
+// The value of the counter is the sum of its shards. A counter with a single
+// shard behaves like a plain counter at location/shard_0.
+//
+// The counter must outlive the futures returned by Increment(), since their
+// transaction functions refer to it.
+class ShardedCounter {
+ public:
+  ShardedCounter(const firebase::database::DatabaseReference& location,
+                 int num_shards);
+
+  // Adds delta to a randomly chosen shard.
+  firebase::Future<firebase::database::DataSnapshot> Increment(int64_t delta);
+  // Adds delta to the shard that key hashes to, so that the increments of one
+  // client always land on the same shard.
+  firebase::Future<firebase::database::DataSnapshot> Increment(
+      int64_t delta, const std::string& key);
+
+  // Reads every shard; pass the result to Sum().
+  firebase::Future<firebase::database::DataSnapshot> Read();
+  // Returns the value of the counter given a snapshot of its location.
+  static int64_t Sum(const firebase::database::DataSnapshot& snapshot);
+
+  int num_shards() const { return num_shards_; }
+  // Number of times a transaction function has run, including retries.
+  int64_t attempts() const { return attempts_; }
+
+ private:
+  firebase::Future<firebase::database::DataSnapshot> IncrementShard(
+      int shard, int64_t delta);
+
+  firebase::database::DatabaseReference location_;
+  int num_shards_;
+  std::atomic<int64_t> attempts_;
+  // Increment() may be called from several threads.
+  std::mutex random_mutex_;
+  std::minstd_rand random_;
+};
+
+#endif  // FIREBASE_TESTAPP_SHARDED_COUNTER_H_  // NOLINT
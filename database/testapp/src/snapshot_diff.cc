@@ -0,0 +1,302 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot_diff.h"  // NOLINT
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+// Type tags mixed into hashes so that e.g. 1 and "1" hash differently.
+enum HashTag : uint64_t {
+  kTagNull = 1,
+  kTagInt64,
+  kTagDouble,
+  kTagBool,
+  kTagString,
+  kTagBlob,
+  kTagContainer,
+};
+
+// splitmix64's finalizer.
+uint64_t Mix(uint64_t value) {
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+// 64-bit FNV-1a.
+uint64_t HashBytes(const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint64_t Combine(uint64_t hash, uint64_t value) {
+  return Mix(hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6)));
+}
+
+const uint64_t kNullHash = Mix(kTagNull);
+
+uint64_t HashLeaf(const firebase::Variant& value) {
+  switch (value.type()) {
+    case firebase::Variant::kTypeInt64: {
+      int64_t i = value.int64_value();
+      return Combine(kTagInt64, HashBytes(&i, sizeof(i)));
+    }
+    case firebase::Variant::kTypeDouble: {
+      double d = value.double_value();
+      return Combine(kTagDouble, HashBytes(&d, sizeof(d)));
+    }
+    case firebase::Variant::kTypeBool:
+      return Combine(kTagBool, value.bool_value() ? 1 : 0);
+    case firebase::Variant::kTypeStaticString:
+    case firebase::Variant::kTypeMutableString: {
+      const char* s = value.string_value();
+      return Combine(kTagString, HashBytes(s, strlen(s)));
+    }
+    case firebase::Variant::kTypeStaticBlob:
+    case firebase::Variant::kTypeMutableBlob:
+      return Combine(kTagBlob, HashBytes(value.blob_data(), value.blob_size()));
+    default:
+      return kNullHash;
+  }
+}
+
+// Map keys from the database are strings, but a Variant built by hand may use
+// other types.
+std::string KeyString(const firebase::Variant& key) {
+  return key.is_string() ? std::string(key.string_value())
+                         : key.AsString().string_value();
+}
+
+int CompareKeys(const char* a, size_t a_size, const char* b, size_t b_size) {
+  int result = memcmp(a, b, std::min(a_size, b_size));
+  if (result) return result;
+  return a_size < b_size ? -1 : a_size > b_size ? 1 : 0;
+}
+
+void AppendKey(const char* key, size_t size, std::string* path) {
+  if (!path->empty()) path->push_back('/');
+  path->append(key, size);
+}
+
+}  // namespace
+
+SnapshotDiffer::SnapshotDiffer() : nodes_compared_(0) { Clear(); }
+
+void SnapshotDiffer::Clear() {
+  Node root = {kNullHash, 0, 0, 0, 0, true};
+  nodes_.assign(1, root);
+  keys_.clear();
+  nodes_compared_ = 0;
+}
+
+void SnapshotDiffer::Update(const firebase::Variant& value,
+                            std::vector<SnapshotChange>* changes) {
+  next_.nodes.clear();
+  next_.keys.clear();
+  next_.values.clear();
+  Node root = {0, 0, 0, 0, 0, true};
+  next_.nodes.push_back(root);
+  next_.values.push_back(&value);
+  Build(0, &next_);
+
+  nodes_compared_ = 0;
+  std::string path;
+  Diff(0, 0, &path, changes);
+
+  // Keep the new tree, and the old tree's storage for the next Update().
+  nodes_.swap(next_.nodes);
+  keys_.swap(next_.keys);
+  next_.values.clear();
+}
+
+void SnapshotDiffer::Build(uint32_t index, Tree* tree) {
+  const firebase::Variant& value = *tree->values[index];
+  size_t count = value.is_map()      ? value.map().size()
+                 : value.is_vector() ? value.vector().size()
+                                     : 0;
+  if (count == 0) {
+    // Empty containers don't exist in the database, so they're null.
+    tree->nodes[index].hash = HashLeaf(value);
+    return;
+  }
+
+  // Lay out the children contiguously, sorted by key, before descending into
+  // any of them. The scratch entries are shared by every level, and popped
+  // before descending.
+  size_t base = entries_.size();
+  if (value.is_map()) {
+    for (auto& entry : value.map()) {
+      entries_.push_back(std::make_pair(KeyString(entry.first), &entry.second));
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      entries_.push_back(std::make_pair(std::to_string(i), &value.vector()[i]));
+    }
+    // "10" sorts before "2", as keys are compared as strings.
+    std::sort(entries_.begin() + base, entries_.end());
+  }
+  uint32_t first = static_cast<uint32_t>(tree->nodes.size());
+  for (size_t i = base; i < entries_.size(); i++) {
+    const std::string& key = entries_[i].first;
+    Node child = {0, static_cast<uint32_t>(tree->keys.size()),
+                  static_cast<uint32_t>(key.size()), 0, 0, true};
+    tree->keys.append(key);
+    tree->nodes.push_back(child);
+    tree->values.push_back(entries_[i].second);
+  }
+  entries_.resize(base);
+
+  uint64_t hash = kTagContainer;
+  for (uint32_t i = first; i < first + count; i++) {
+    Build(i, tree);
+    const Node& child = tree->nodes[i];
+    hash = Combine(hash, HashBytes(&tree->keys[child.key_offset],
+                                   child.key_size));
+    hash = Combine(hash, child.hash);
+  }
+  Node& node = tree->nodes[index];
+  node.hash = hash;
+  node.first_child = first;
+  node.child_count = static_cast<uint32_t>(count);
+  node.leaf = false;
+}
+
+void SnapshotDiffer::Diff(uint32_t old_index, uint32_t new_index,
+                          std::string* path,
+                          std::vector<SnapshotChange>* changes) {
+  nodes_compared_++;
+  const Node& old_node = nodes_[old_index];
+  const Node& new_node = next_.nodes[new_index];
+  if (old_node.hash == new_node.hash) return;
+
+  if (old_node.leaf && new_node.leaf) {
+    SnapshotChange change;
+    change.type = old_node.hash == kNullHash   ? SnapshotChange::kAdded
+                  : new_node.hash == kNullHash ? SnapshotChange::kRemoved
+                                               : SnapshotChange::kChanged;
+    change.path = *path;
+    if (new_node.hash != kNullHash) change.value = *next_.values[new_index];
+    changes->push_back(change);
+    return;
+  }
+  if (old_node.leaf || new_node.leaf) {
+    ReportRemoved(old_index, path, changes);
+    ReportAdded(new_index, path, changes);
+    return;
+  }
+
+  // Both are containers: walk their sorted children side by side.
+  size_t path_size = path->size();
+  uint32_t old_child = old_node.first_child;
+  uint32_t old_end = old_child + old_node.child_count;
+  uint32_t new_child = new_node.first_child;
+  uint32_t new_end = new_child + new_node.child_count;
+  while (old_child < old_end || new_child < new_end) {
+    int order;
+    if (old_child == old_end) {
+      order = 1;
+    } else if (new_child == new_end) {
+      order = -1;
+    } else {
+      const Node& a = nodes_[old_child];
+      const Node& b = next_.nodes[new_child];
+      order = CompareKeys(&keys_[a.key_offset], a.key_size,
+                          &next_.keys[b.key_offset], b.key_size);
+    }
+    if (order <= 0) {
+      const Node& a = nodes_[old_child];
+      AppendKey(&keys_[a.key_offset], a.key_size, path);
+    } else {
+      const Node& b = next_.nodes[new_child];
+      AppendKey(&next_.keys[b.key_offset], b.key_size, path);
+    }
+    if (order < 0) {
+      ReportRemoved(old_child++, path, changes);
+    } else if (order > 0) {
+      ReportAdded(new_child++, path, changes);
+    } else {
+      Diff(old_child++, new_child++, path, changes);
+    }
+    path->resize(path_size);
+  }
+}
+
+void SnapshotDiffer::ReportRemoved(uint32_t old_index, std::string* path,
+                                   std::vector<SnapshotChange>* changes) const {
+  const Node& node = nodes_[old_index];
+  if (node.leaf) {
+    if (node.hash == kNullHash) return;
+    SnapshotChange change;
+    change.type = SnapshotChange::kRemoved;
+    change.path = *path;
+    changes->push_back(change);
+    return;
+  }
+  size_t path_size = path->size();
+  for (uint32_t i = node.first_child; i < node.first_child + node.child_count;
+       i++) {
+    AppendKey(&keys_[nodes_[i].key_offset], nodes_[i].key_size, path);
+    ReportRemoved(i, path, changes);
+    path->resize(path_size);
+  }
+}
+
+void SnapshotDiffer::ReportAdded(uint32_t new_index, std::string* path,
+                                 std::vector<SnapshotChange>* changes) const {
+  const Node& node = next_.nodes[new_index];
+  if (node.leaf) {
+    if (node.hash == kNullHash) return;
+    SnapshotChange change;
+    change.type = SnapshotChange::kAdded;
+    change.path = *path;
+    change.value = *next_.values[new_index];
+    changes->push_back(change);
+    return;
+  }
+  size_t path_size = path->size();
+  for (uint32_t i = node.first_child; i < node.first_child + node.child_count;
+       i++) {
+    const Node& child = next_.nodes[i];
+    AppendKey(&next_.keys[child.key_offset], child.key_size, path);
+    ReportAdded(i, path, changes);
+    path->resize(path_size);
+  }
+}
+
+void DiffingValueListener::OnValueChanged(
+    const firebase::database::DataSnapshot& snapshot) {
+  changes_.clear();
+  differ_.Update(snapshot.value(), &changes_);
+  if (!changes_.empty() && callback_) callback_(changes_);
+}
+
+void DiffingValueListener::OnCancelled(
+    const firebase::database::Error& error_code, const char* error_message) {
+  LogMessage("ERROR: DiffingValueListener canceled: %d: %s", error_code,
+             error_message);
+}
@@ -0,0 +1,127 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_SNAPSHOT_DIFF_H_  // NOLINT
+#define FIREBASE_TESTAPP_SNAPSHOT_DIFF_H_  // NOLINT
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "firebase/database.h"
+#include "firebase/variant.h"
+
+// A change to one leaf of a snapshot.
+struct SnapshotChange {
+  enum Type { kAdded, kChanged, kRemoved };
+
+  Type type;
+  // Slash separated path of the leaf, relative to the snapshot.
+  std::string path;
+  // The new value of the leaf, or null if it was removed.
+  firebase::Variant value;
+};
+
+// Finds what changed between successive snapshots of a location, so that a
+// listener can update only what changed instead of keeping a copy of the
+// whole previous value to compare against.
+//
+// Instead of the previous value, the differ keeps a compact tree of hashes:
+// one node per key, laid out in a single array, holding the hash of the
+// subtree below it. When the next value arrives its hashes are computed in
+// one pass, and the comparison skips every branch whose hash didn't change,
+// only descending where something did.
+class SnapshotDiffer {
+ public:
+  SnapshotDiffer();
+
+  // Compares value with the previous value passed to Update() (initially
+  // empty), appends a change for each leaf that was added, changed or
+  // removed to changes, and remembers value's hashes for next time.
+  void Update(const firebase::Variant& value,
+              std::vector<SnapshotChange>* changes);
+  // Forgets the previous value.
+  void Clear();
+
+  // Number of nodes in the tree of the last value.
+  size_t size() const { return nodes_.size(); }
+  // Number of pairs of nodes compared by the last Update(). Unchanged
+  // branches are skipped, so this is usually much less than size().
+  size_t nodes_compared() const { return nodes_compared_; }
+
+ private:
+  struct Node {
+    uint64_t hash;
+    // The node's key, in keys_.
+    uint32_t key_offset;
+    uint32_t key_size;
+    // Children are contiguous in nodes_, sorted by key. A leaf has none.
+    uint32_t first_child;
+    uint32_t child_count;
+    bool leaf;
+  };
+
+  // A tree being built from a value, or kept from the last one.
+  struct Tree {
+    std::vector<Node> nodes;
+    std::string keys;
+    // The value each node was built from. Only valid during Update().
+    std::vector<const firebase::Variant*> values;
+  };
+
+  // Computes the hash of the node at index from the value it was built from,
+  // adding its descendants to tree.
+  void Build(uint32_t index, Tree* tree);
+  void Diff(uint32_t old_index, uint32_t new_index, std::string* path,
+            std::vector<SnapshotChange>* changes);
+  // Reports every leaf under a node of the old or new tree.
+  void ReportRemoved(uint32_t old_index, std::string* path,
+                     std::vector<SnapshotChange>* changes) const;
+  void ReportAdded(uint32_t new_index, std::string* path,
+                   std::vector<SnapshotChange>* changes) const;
+
+  std::vector<Node> nodes_;
+  std::string keys_;
+  // The tree of the value being compared, swapped in at the end of Update().
+  Tree next_;
+  // Children of the containers being built, before they are sorted.
+  std::vector<std::pair<std::string, const firebase::Variant*>> entries_;
+  size_t nodes_compared_;
+};
+
+// A ValueListener that passes on what changed with each new value rather
+// than the whole snapshot.
+class DiffingValueListener : public firebase::database::ValueListener {
+ public:
+  typedef std::function<void(const std::vector<SnapshotChange>& changes)>
+      ChangesCallback;
+
+  explicit DiffingValueListener(const ChangesCallback& callback)
+      : callback_(callback) {}
+
+  void OnValueChanged(
+      const firebase::database::DataSnapshot& snapshot) override;
+  void OnCancelled(const firebase::database::Error& error_code,
+                   const char* error_message) override;
+
+ private:
+  SnapshotDiffer differ_;
+  ChangesCallback callback_;
+  std::vector<SnapshotChange> changes_;
+};
+
+#endif  // FIREBASE_TESTAPP_SNAPSHOT_DIFF_H_  // NOLINT
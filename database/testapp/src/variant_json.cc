@@ -0,0 +1,606 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "variant_json.h"  // NOLINT
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIREBASE_TESTAPP_JSON_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FIREBASE_TESTAPP_JSON_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif  // defined(_MSC_VER)
+
+namespace {
+
+// Returns the index of the lowest set bit of a non-zero value.
+inline unsigned LowestBit(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;  // NOLINT
+  _BitScanForward64(&index, value);
+  return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+  unsigned long index;  // NOLINT
+  if (_BitScanForward(&index, static_cast<uint32_t>(value))) {
+    return static_cast<unsigned>(index);
+  }
+  _BitScanForward(&index, static_cast<uint32_t>(value >> 32));
+  return static_cast<unsigned>(index) + 32;
+#else
+  return static_cast<unsigned>(__builtin_ctzll(value));
+#endif  // defined(_MSC_VER)
+}
+
+inline bool NeedsEscape(unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\';
+}
+
+inline bool IsWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+void AppendInt64(int64_t value, JsonBuffer* output) {
+  char digits[24];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  // Work with the magnitude as unsigned so that INT64_MIN doesn't overflow.
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value)
+                                 : static_cast<uint64_t>(value);
+  do {
+    *--p = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude);
+  if (value < 0) *--p = '-';
+  output->Append(p, end - p);
+}
+
+void AppendScalar(const firebase::Variant& value, JsonBuffer* output) {
+  switch (value.type()) {
+    case firebase::Variant::kTypeInt64:
+      AppendInt64(value.int64_value(), output);
+      break;
+    case firebase::Variant::kTypeDouble:
+      // JSON can't represent infinities or NaN.
+      if (std::isfinite(value.double_value())) {
+        char number[32];
+        int length =
+            snprintf(number, sizeof(number), "%.17g", value.double_value());
+        // Keep integral Doubles distinguishable from Int64s.
+        if (!strpbrk(number, ".e")) {
+          number[length++] = '.';
+          number[length++] = '0';
+        }
+        output->Append(number, length);
+      } else {
+        output->Append("null", 4);
+      }
+      break;
+    case firebase::Variant::kTypeBool:
+      if (value.bool_value()) {
+        output->Append("true", 4);
+      } else {
+        output->Append("false", 5);
+      }
+      break;
+    case firebase::Variant::kTypeStaticString:
+    case firebase::Variant::kTypeMutableString: {
+      const char* string = value.string_value();
+      AppendJsonString(string, strlen(string), output);
+      break;
+    }
+    default:
+      output->Append("null", 4);
+      break;
+  }
+}
+
+// Parses a JSON document held in memory. Containers are tracked on an
+// explicit stack rather than by recursion.
+class Parser {
+ public:
+  Parser(const char* json, size_t size)
+      : begin_(json), p_(json), end_(json + size) {}
+
+  bool Parse(firebase::Variant* result) {
+    // Containers that are still open, and for maps the key of the member
+    // being parsed.
+    struct Frame {
+      firebase::Variant container;
+      std::string key;
+    };
+    std::vector<Frame> stack;
+    firebase::Variant value;
+    for (;;) {
+      // Parse a value. Opening a container moves on to its first element.
+      SkipWhitespace();
+      if (p_ == end_) return Fail("unexpected end of input");
+      char c = *p_;
+      if (c == '{' || c == '[') {
+        p_++;
+        stack.push_back(Frame());
+        Frame& frame = stack.back();
+        frame.container = c == '{' ? firebase::Variant::EmptyMap()
+                                   : firebase::Variant::EmptyVector();
+        SkipWhitespace();
+        if (p_ < end_ && *p_ == (c == '{' ? '}' : ']')) {
+          p_++;
+          value = std::move(frame.container);
+          stack.pop_back();
+        } else if (c == '{') {
+          if (!ParseKey(&frame.key)) return false;
+          continue;
+        } else {
+          continue;
+        }
+      } else if (!ParseScalar(&value)) {
+        return false;
+      }
+
+      // Add the finished value to its container, closing as many containers
+      // as the input does.
+      for (;;) {
+        if (stack.empty()) {
+          SkipWhitespace();
+          if (p_ != end_) return Fail("unexpected data after the document");
+          *result = std::move(value);
+          return true;
+        }
+        Frame& frame = stack.back();
+        bool is_map = frame.container.is_map();
+        if (is_map) {
+          frame.container.map()[firebase::Variant(frame.key)] =
+              std::move(value);
+        } else {
+          frame.container.vector().push_back(std::move(value));
+        }
+        SkipWhitespace();
+        if (p_ == end_) return Fail("unexpected end of input");
+        char next = *p_++;
+        if (next == ',') {
+          if (is_map && !ParseKey(&frame.key)) return false;
+          break;
+        }
+        if (next != (is_map ? '}' : ']')) {
+          return Fail(is_map ? "expected ',' or '}'" : "expected ',' or ']'");
+        }
+        value = std::move(frame.container);
+        stack.pop_back();
+      }
+    }
+  }
+
+  const std::string& error() const { return error_; }
+
+ private:
+  bool Fail(const char* message) {
+    char where[64];
+    snprintf(where, sizeof(where), " at byte %lu",
+             static_cast<unsigned long>(p_ - begin_));  // NOLINT
+    error_ = std::string("JSON parse error: ") + message + where;
+    return false;
+  }
+
+  void SkipWhitespace() {
+    while (p_ < end_ && IsWhitespace(*p_)) p_++;
+  }
+
+  // Parses a member name and the colon that follows it.
+  bool ParseKey(std::string* key) {
+    SkipWhitespace();
+    if (p_ == end_ || *p_ != '"') return Fail("expected a member name");
+    if (!ParseString(key)) return false;
+    SkipWhitespace();
+    if (p_ == end_ || *p_ != ':') return Fail("expected ':'");
+    p_++;
+    return true;
+  }
+
+  bool ParseScalar(firebase::Variant* value) {
+    switch (*p_) {
+      case '"': {
+        std::string string;
+        if (!ParseString(&string)) return false;
+        *value = firebase::Variant(std::move(string));
+        return true;
+      }
+      case 't':
+        return ParseLiteral("true", firebase::Variant(true), value);
+      case 'f':
+        return ParseLiteral("false", firebase::Variant(false), value);
+      case 'n':
+        return ParseLiteral("null", firebase::Variant::Null(), value);
+      default:
+        return ParseNumber(value);
+    }
+  }
+
+  bool ParseLiteral(const char* literal, const firebase::Variant& literal_value,
+                    firebase::Variant* value) {
+    size_t length = strlen(literal);
+    if (static_cast<size_t>(end_ - p_) < length ||
+        memcmp(p_, literal, length) != 0) {
+      return Fail("invalid literal");
+    }
+    p_ += length;
+    *value = literal_value;
+    return true;
+  }
+
+  bool ParseString(std::string* string) {
+    p_++;  // Opening quote.
+    string->clear();
+    for (;;) {
+      size_t run = FindJsonEscape(p_, end_ - p_);
+      string->append(p_, run);
+      p_ += run;
+      if (p_ == end_) return Fail("unterminated string");
+      char c = *p_++;
+      if (c == '"') return true;
+      if (c != '\\') return Fail("control character in string");
+      if (p_ == end_) return Fail("unterminated string");
+      c = *p_++;
+      switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+          string->push_back(c);
+          break;
+        case 'b':
+          string->push_back('\b');
+          break;
+        case 'f':
+          string->push_back('\f');
+          break;
+        case 'n':
+          string->push_back('\n');
+          break;
+        case 'r':
+          string->push_back('\r');
+          break;
+        case 't':
+          string->push_back('\t');
+          break;
+        case 'u': {
+          uint32_t code_point;
+          if (!ParseHex4(&code_point)) return false;
+          if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+            // A high surrogate must be followed by an escaped low surrogate.
+            uint32_t low;
+            if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+              return Fail("unpaired surrogate");
+            }
+            p_ += 2;
+            if (!ParseHex4(&low)) return false;
+            if (low < 0xDC00 || low > 0xDFFF) {
+              return Fail("unpaired surrogate");
+            }
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                         (low - 0xDC00);
+          }
+          AppendUtf8(code_point, string);
+          break;
+        }
+        default:
+          return Fail("invalid escape");
+      }
+    }
+  }
+
+  bool ParseHex4(uint32_t* unit) {
+    if (end_ - p_ < 4) return Fail("invalid \\u escape");
+    *unit = 0;
+    for (int i = 0; i < 4; i++) {
+      char h = *p_++;
+      *unit <<= 4;
+      if (h >= '0' && h <= '9') {
+        *unit |= h - '0';
+      } else if (h >= 'a' && h <= 'f') {
+        *unit |= h - 'a' + 10;
+      } else if (h >= 'A' && h <= 'F') {
+        *unit |= h - 'A' + 10;
+      } else {
+        return Fail("invalid \\u escape");
+      }
+    }
+    return true;
+  }
+
+  bool ParseNumber(firebase::Variant* value) {
+    const char* start = p_;
+    bool negative = p_ < end_ && *p_ == '-';
+    if (negative) p_++;
+    // Accumulate integers directly, which covers most numbers in practice.
+    uint64_t magnitude = 0;
+    const char* digits = p_;
+    while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+      magnitude = magnitude * 10 + (*p_ - '0');
+      p_++;
+    }
+    size_t digit_count = p_ - digits;
+    if (digit_count == 0) return Fail("unexpected character");
+    bool integral = p_ == end_ || (*p_ != '.' && *p_ != 'e' && *p_ != 'E');
+    // 18 digits always fit in an int64_t.
+    if (integral && digit_count <= 18) {
+      int64_t integer = static_cast<int64_t>(magnitude);
+      *value = firebase::Variant(negative ? -integer : integer);
+      return true;
+    }
+    while (p_ < end_ && ((*p_ >= '0' && *p_ <= '9') || *p_ == '.' ||
+                         *p_ == 'e' || *p_ == 'E' || *p_ == '+' ||
+                         *p_ == '-')) {
+      p_++;
+    }
+    // strtod() needs a terminated string.
+    std::string text(start, p_ - start);
+    char* end = nullptr;
+    if (integral) {
+      errno = 0;
+      long long integer = strtoll(text.c_str(), &end, 10);  // NOLINT
+      if (errno == 0 && *end == '\0') {
+        *value = firebase::Variant(static_cast<int64_t>(integer));
+        return true;
+      }
+    }
+    double number = strtod(text.c_str(), &end);
+    if (*end != '\0') return Fail("invalid number");
+    *value = firebase::Variant(number);
+    return true;
+  }
+
+  const char* begin_;
+  const char* p_;
+  const char* end_;
+  std::string error_;
+};
+
+}  // namespace
+
+JsonBuffer::JsonBuffer(size_t block_size)
+    : block_size_(block_size > 0 ? block_size : 1),
+      current_(0),
+      cursor_(nullptr),
+      limit_(nullptr) {}
+
+void JsonBuffer::NextBlock() {
+  if (cursor_) current_++;
+  if (current_ == blocks_.size()) {
+    blocks_.push_back(std::unique_ptr<char[]>(new char[block_size_]));
+  }
+  cursor_ = blocks_[current_].get();
+  limit_ = cursor_ + block_size_;
+}
+
+void JsonBuffer::Append(const char* data, size_t size) {
+  while (size) {
+    if (cursor_ == limit_) NextBlock();
+    size_t count = static_cast<size_t>(limit_ - cursor_);
+    if (count > size) count = size;
+    memcpy(cursor_, data, count);
+    cursor_ += count;
+    data += count;
+    size -= count;
+  }
+}
+
+size_t JsonBuffer::size() const {
+  if (!cursor_) return 0;
+  return current_ * block_size_ +
+         static_cast<size_t>(cursor_ - blocks_[current_].get());
+}
+
+void JsonBuffer::Clear() {
+  current_ = 0;
+  cursor_ = nullptr;
+  limit_ = nullptr;
+}
+
+std::string JsonBuffer::ToString() const {
+  std::string result;
+  result.reserve(size());
+  ForEachBlock(
+      [&result](const char* data, size_t size) { result.append(data, size); });
+  return result;
+}
+
+size_t FindJsonEscape(const char* data, size_t size) {
+  size_t i = 0;
+#if defined(FIREBASE_TESTAPP_JSON_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i max_control = _mm_set1_epi8(0x1F);
+  for (; i + 16 <= size; i += 16) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    // There is no unsigned compare, but min(c, 0x1F) == c iff c <= 0x1F.
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk);
+    __m128i special =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                  _mm_cmpeq_epi8(chunk, backslash)),
+                     control);
+    int mask = _mm_movemask_epi8(special);
+    if (mask) return i + LowestBit(static_cast<uint64_t>(mask));
+  }
+#elif defined(FIREBASE_TESTAPP_JSON_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(0x20);
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+    uint8x16_t special =
+        vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                 vcltq_u8(chunk, space));
+    // Narrow each byte of the comparison to a nibble of a 64-bit mask.
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+    if (mask) return i + (LowestBit(mask) >> 2);
+  }
+#endif
+  for (; i < size; i++) {
+    if (NeedsEscape(static_cast<unsigned char>(data[i]))) return i;
+  }
+  return size;
+}
+
+void AppendUtf8(uint32_t code_point, std::string* output) {
+  if (code_point < 0x80) {
+    output->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    output->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    output->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    output->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+void AppendJsonString(const char* data, size_t size, JsonBuffer* output) {
+  static const char kHex[] = "0123456789abcdef";
+  output->Append('"');
+  for (;;) {
+    size_t run = FindJsonEscape(data, size);
+    output->Append(data, run);
+    if (run == size) break;
+    unsigned char c = static_cast<unsigned char>(data[run]);
+    data += run + 1;
+    size -= run + 1;
+    switch (c) {
+      case '"':
+        output->Append("\\\"", 2);
+        break;
+      case '\\':
+        output->Append("\\\\", 2);
+        break;
+      case '\b':
+        output->Append("\\b", 2);
+        break;
+      case '\f':
+        output->Append("\\f", 2);
+        break;
+      case '\n':
+        output->Append("\\n", 2);
+        break;
+      case '\r':
+        output->Append("\\r", 2);
+        break;
+      case '\t':
+        output->Append("\\t", 2);
+        break;
+      default: {
+        char escape[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+        output->Append(escape, sizeof(escape));
+        break;
+      }
+    }
+  }
+  output->Append('"');
+}
+
+void VariantToJson(const firebase::Variant& value, JsonBuffer* output) {
+  struct Frame {
+    const firebase::Variant* container;
+    std::map<firebase::Variant, firebase::Variant>::const_iterator map_it;
+    size_t index;
+  };
+  std::vector<Frame> stack;
+  const firebase::Variant* next = &value;
+  for (;;) {
+    if (next) {
+      if (next->is_map()) {
+        output->Append('{');
+        Frame frame = {next, next->map().begin(), 0};
+        stack.push_back(frame);
+      } else if (next->is_vector()) {
+        output->Append('[');
+        Frame frame = {next, std::map<firebase::Variant,
+                                      firebase::Variant>::const_iterator(),
+                       0};
+        stack.push_back(frame);
+      } else {
+        AppendScalar(*next, output);
+      }
+      next = nullptr;
+    }
+    if (stack.empty()) return;
+
+    // Move to the next element of the innermost container.
+    Frame& frame = stack.back();
+    if (frame.container->is_map()) {
+      if (frame.map_it == frame.container->map().end()) {
+        output->Append('}');
+        stack.pop_back();
+        continue;
+      }
+      if (frame.index++) output->Append(',');
+      const firebase::Variant& key = frame.map_it->first;
+      if (key.is_string()) {
+        const char* string = key.string_value();
+        AppendJsonString(string, strlen(string), output);
+      } else {
+        std::string string = key.AsString().string_value();
+        AppendJsonString(string.data(), string.size(), output);
+      }
+      output->Append(':');
+      next = &frame.map_it->second;
+      ++frame.map_it;
+    } else {
+      const std::vector<firebase::Variant>& vector = frame.container->vector();
+      if (frame.index == vector.size()) {
+        output->Append(']');
+        stack.pop_back();
+        continue;
+      }
+      if (frame.index) output->Append(',');
+      next = &vector[frame.index++];
+    }
+  }
+}
+
+std::string VariantToJson(const firebase::Variant& value) {
+  JsonBuffer buffer;
+  VariantToJson(value, &buffer);
+  return buffer.ToString();
+}
+
+bool JsonToVariant(const char* json, size_t size, firebase::Variant* value,
+                   std::string* error) {
+  Parser parser(json, size);
+  if (parser.Parse(value)) return true;
+  if (error) *error = parser.error();
+  return false;
+}
+
+bool JsonToVariant(const std::string& json, firebase::Variant* value,
+                   std::string* error) {
+  return JsonToVariant(json.data(), json.size(), value, error);
+}
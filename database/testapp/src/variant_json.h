@@ -0,0 +1,98 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_VARIANT_JSON_H_  // NOLINT
+#define FIREBASE_TESTAPP_VARIANT_JSON_H_  // NOLINT
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "firebase/variant.h"
+
+// An append-only output buffer made of fixed size blocks. Growing it never
+// moves what has already been written, and Clear() keeps the blocks around so
+// that a buffer reused for many values stops allocating.
+class JsonBuffer {
+ public:
+  explicit JsonBuffer(size_t block_size = 64 * 1024);
+
+  void Append(const char* data, size_t size);
+  void Append(char c) {
+    if (cursor_ == limit_) NextBlock();
+    *cursor_++ = c;
+  }
+
+  // Number of bytes appended since the last Clear().
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  void Clear();
+
+  // Calls write(const char* data, size_t size) for each block, in order.
+  template <typename WriteFunction>
+  void ForEachBlock(WriteFunction write) const {
+    // Nothing has been written since the last Clear().
+    if (!cursor_) return;
+    for (size_t i = 0; i <= current_ && i < blocks_.size(); i++) {
+      size_t used = i == current_
+                        ? static_cast<size_t>(cursor_ - blocks_[i].get())
+                        : block_size_;
+      if (used) write(blocks_[i].get(), used);
+    }
+  }
+
+  std::string ToString() const;
+
+ private:
+  void NextBlock();
+
+  size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  // Index of the block being written, and the free space left in it.
+  size_t current_;
+  char* cursor_;
+  char* limit_;
+};
+
+// Returns the offset of the first byte in data that can't appear unescaped in
+// a JSON string (a quote, a backslash or a control character), or size if
+// there is none. Uses SSE2 or NEON to check 16 bytes at a time where
+// available.
+size_t FindJsonEscape(const char* data, size_t size);
+
+// Appends the UTF-8 encoding of code_point to output.
+void AppendUtf8(uint32_t code_point, std::string* output);
+
+// Appends data to output as a quoted and escaped JSON string.
+void AppendJsonString(const char* data, size_t size, JsonBuffer* output);
+
+// Appends the JSON encoding of value to output. Containers are walked with an
+// explicit stack, so deeply nested values can't overflow the call stack.
+// Values that JSON can't represent (blobs, infinities) are written as null, and
+// integral Doubles are written with a fraction so that they read back as
+// Doubles.
+void VariantToJson(const firebase::Variant& value, JsonBuffer* output);
+std::string VariantToJson(const firebase::Variant& value);
+
+// Parses a complete JSON document into value. Numbers without a fraction or
+// exponent that fit in 64 bits become Int64 Variants, other numbers Doubles.
+// On failure returns false and describes the problem in error, if given.
+bool JsonToVariant(const char* json, size_t size, firebase::Variant* value,
+                   std::string* error);
+bool JsonToVariant(const std::string& json, firebase::Variant* value,
+                   std::string* error);
+
+#endif  // FIREBASE_TESTAPP_VARIANT_JSON_H_  // NOLINT
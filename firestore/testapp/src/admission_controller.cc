@@ -0,0 +1,135 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "admission_controller.h"  // NOLINT
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+const int kPollMs = 1;
+// Weight of each completion in the latency moving average.
+const double kLatencySmoothing = 0.1;
+
+}  // namespace
+
+AdmissionController::AdmissionController(const AdmissionOptions& options)
+    : options_(options),
+      limit_(options.initial_limit),
+      last_decrease_(Clock::now()) {}
+
+bool AdmissionController::HasRoomLocked() const {
+  return static_cast<double>(in_flight_.size() + reserved_) <
+         std::max(limit_, 1.0);
+}
+
+bool AdmissionController::Acquire(bool block) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  PollLocked();
+  if (!HasRoomLocked()) {
+    if (!block || queued_ >= options_.max_queued) {
+      totals_.rejected++;
+      return false;
+    }
+    queued_++;
+    while (!HasRoomLocked()) {
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+      lock.lock();
+      PollLocked();
+    }
+    queued_--;
+  }
+  reserved_++;
+  totals_.admitted++;
+  return true;
+}
+
+void AdmissionController::Track(const firebase::FutureBase& future) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  reserved_--;
+  Operation operation;
+  operation.future = future;
+  operation.start = Clock::now();
+  in_flight_.push_back(operation);
+}
+
+void AdmissionController::Poll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PollLocked();
+}
+
+void AdmissionController::PollLocked() {
+  Clock::time_point now = Clock::now();
+  for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+    if (it->future.status() == firebase::kFutureStatusPending) {
+      ++it;
+      continue;
+    }
+    double latency_ms =
+        std::chrono::duration<double, std::milli>(now - it->start).count();
+    bool failed = it->future.status() != firebase::kFutureStatusComplete ||
+                  it->future.error() != 0;
+    totals_.completed++;
+    if (failed) totals_.failed++;
+    totals_.latency_ms = totals_.completed == 1
+                             ? latency_ms
+                             : totals_.latency_ms +
+                                   kLatencySmoothing *
+                                       (latency_ms - totals_.latency_ms);
+    if (failed || latency_ms > options_.target_latency_ms) {
+      if (it->start >= last_decrease_) {
+        limit_ = std::max(static_cast<double>(options_.min_limit),
+                          limit_ * options_.decrease_factor);
+        last_decrease_ = now;
+      }
+    } else {
+      limit_ = std::min(static_cast<double>(options_.max_limit),
+                        limit_ + 1.0 / limit_);
+    }
+    it = in_flight_.erase(it);
+  }
+}
+
+void AdmissionController::Drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  PollLocked();
+  while (!in_flight_.empty() || reserved_) {
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    lock.lock();
+    PollLocked();
+  }
+}
+
+AdmissionGauges AdmissionController::gauges() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PollLocked();
+  AdmissionGauges gauges = totals_;
+  gauges.limit = static_cast<int>(limit_);
+  gauges.in_flight = static_cast<int>(in_flight_.size()) + reserved_;
+  gauges.queued = queued_;
+  return gauges;
+}
+
+firebase::Future<void> AdmittedSet(
+    AdmissionController* controller,
+    firebase::firestore::DocumentReference document,
+    const firebase::firestore::MapFieldValue& data,
+    const firebase::firestore::SetOptions& options,
+    bool block) {
+  return controller->Submit<void>(
+      [&]() { return document.Set(data, options); }, block);
+}
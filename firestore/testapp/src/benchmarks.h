@@ -0,0 +1,74 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_BENCHMARKS_H_  // NOLINT
+#define FIREBASE_TESTAPP_BENCHMARKS_H_  // NOLINT
+
+#include <vector>
+
+#include "firebase/firestore.h"
+
+// Benchmarks run by the desktop testapp with "--benchmark=name", instead of
+// the tests. Each one logs its measurements and returns false if it couldn't
+// complete. They write to collections of their own, and are best run against
+// the Firestore emulator (see "--firestore_emulator").
+
+// Returns the value of a "--name=value" command line argument, or nullptr if
+// it wasn't given.
+const char* GetArgument(int argc, const char* argv[], const char* name);
+
+// Logs the count, mean and percentiles of latencies, given in seconds, as
+// "  name: ...".
+void LogLatencies(const char* name, std::vector<double> latencies);
+
+// "--benchmark=bulk": writes documents with a BulkWriter, first with one
+// batch committing at a time and then with several, and reports the
+// documents written per second and the commit latencies.
+bool RunBulkWriterBenchmark(firebase::firestore::Firestore* firestore,
+                            int argc, const char* argv[]);
+
+// "--benchmark=merge": runs overlapping range queries one after another,
+// merging their results in memory, and then with a MergedQuery, with and
+// without a limit, and reports the time taken and documents fetched by each.
+bool RunMergedQueryBenchmark(firebase::firestore::Firestore* firestore,
+                             int argc, const char* argv[]);
+
+// "--benchmark=scan": writes documents with automatic IDs, then reads them all
+// with ScanCollection() split into 1, 2, 4 and more partitions, and reports
+// the documents read per second for each.
+bool RunScanBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                      const char* argv[]);
+
+// "--benchmark=builder": builds documents with MapFieldValue literals and
+// with a DocumentBuilder, on their own and added to write batches that are
+// never committed, and reports the heap allocations and time per document.
+bool RunDocumentBuilderBenchmark(firebase::firestore::Firestore* firestore,
+                                 int argc, const char* argv[]);
+
+// "--benchmark=cache": reads a collection with Firestore instances of their
+// own, with persistence on and off and a range of cache sizes, and reports
+// the latency of queries from the server and from the cache, the memory and
+// disk each configuration used and how many documents stayed cached.
+bool RunCacheBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                       const char* argv[]);
+
+// "--benchmark=listeners": registers hundreds of snapshot listeners, on
+// single documents and on queries, then writes to the documents from another
+// thread at a steady rate, and reports the memory used per registration, the
+// rate at which snapshots are delivered and the lag from each write to its
+// delivery.
+bool RunListenerBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                          const char* argv[]);
+
+#endif  // FIREBASE_TESTAPP_BENCHMARKS_H_  // NOLINT
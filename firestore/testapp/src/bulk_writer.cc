@@ -0,0 +1,176 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bulk_writer.h"  // NOLINT
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+const int kPollMs = 1;
+
+// Whether a commit that failed with error may succeed if it is made again.
+bool IsRetryable(firebase::firestore::Error error) {
+  switch (error) {
+    case firebase::firestore::kErrorAborted:
+    case firebase::firestore::kErrorDeadlineExceeded:
+    case firebase::firestore::kErrorResourceExhausted:
+    case firebase::firestore::kErrorUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+BulkWriter::BulkWriter(firebase::firestore::Firestore* firestore,
+                       const BulkWriterOptions& options)
+    : firestore_(firestore), options_(options) {
+  options_.batch_size = std::max(1, std::min(options_.batch_size, 500));
+  options_.max_in_flight = std::max(1, options_.max_in_flight);
+  pending_.reserve(options_.batch_size);
+}
+
+BulkWriter::~BulkWriter() { Flush(); }
+
+void BulkWriter::Set(const firebase::firestore::DocumentReference& document,
+                     firebase::firestore::MapFieldValue data,
+                     const firebase::firestore::SetOptions& options) {
+  Add(Operation{Operation::kSet, document, std::move(data), options});
+}
+
+void BulkWriter::Update(const firebase::firestore::DocumentReference& document,
+                        firebase::firestore::MapFieldValue data) {
+  Add(Operation{Operation::kUpdate, document, std::move(data),
+                firebase::firestore::SetOptions()});
+}
+
+void BulkWriter::Delete(
+    const firebase::firestore::DocumentReference& document) {
+  Add(Operation{Operation::kDelete, document,
+                firebase::firestore::MapFieldValue(),
+                firebase::firestore::SetOptions()});
+}
+
+bool BulkWriter::Flush() {
+  if (!pending_.empty()) Dispatch();
+  while (!in_flight_.empty()) {
+    Poll();
+    if (!in_flight_.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+  }
+  return stats_.batches_failed == 0;
+}
+
+void BulkWriter::Add(Operation operation) {
+  if (!started_) {
+    started_ = true;
+    start_ = Clock::now();
+  }
+  pending_.push_back(std::move(operation));
+  if (pending_.size() >= static_cast<size_t>(options_.batch_size)) {
+    Dispatch();
+  }
+}
+
+void BulkWriter::Dispatch() {
+  Poll();
+  while (in_flight_.size() >= static_cast<size_t>(options_.max_in_flight)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    Poll();
+  }
+  in_flight_.emplace_back();
+  Batch& batch = in_flight_.back();
+  batch.operations.swap(pending_);
+  pending_.reserve(options_.batch_size);
+  Commit(&batch);
+}
+
+void BulkWriter::Commit(Batch* batch) {
+  firebase::firestore::WriteBatch write_batch = firestore_->batch();
+  for (const Operation& operation : batch->operations) {
+    switch (operation.type) {
+      case Operation::kSet:
+        write_batch.Set(operation.document, operation.data, operation.options);
+        break;
+      case Operation::kUpdate:
+        write_batch.Update(operation.document, operation.data);
+        break;
+      case Operation::kDelete:
+        write_batch.Delete(operation.document);
+        break;
+    }
+  }
+  batch->attempts++;
+  batch->waiting = false;
+  batch->started = Clock::now();
+  batch->commit = write_batch.Commit();
+}
+
+void BulkWriter::Poll() {
+  Clock::time_point now = Clock::now();
+  for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+    Batch& batch = *it;
+    if (batch.waiting) {
+      if (now >= batch.retry_at) Commit(&batch);
+      ++it;
+      continue;
+    }
+    if (batch.commit.status() == firebase::kFutureStatusPending) {
+      ++it;
+      continue;
+    }
+    firebase::firestore::Error error =
+        batch.commit.status() == firebase::kFutureStatusComplete
+            ? static_cast<firebase::firestore::Error>(batch.commit.error())
+            : firebase::firestore::kErrorUnknown;
+    if (error == firebase::firestore::kErrorOk) {
+      stats_.operations_written += batch.operations.size();
+      stats_.batches_committed++;
+      stats_.commit_seconds.push_back(
+          std::chrono::duration<double>(now - batch.started).count());
+    } else if (IsRetryable(error) && batch.attempts < options_.max_attempts) {
+      double delay_ms = options_.initial_backoff_ms;
+      for (int i = 1; i < batch.attempts; i++) {
+        delay_ms *= options_.backoff_multiplier;
+      }
+      delay_ms =
+          std::min(delay_ms, static_cast<double>(options_.max_backoff_ms));
+      batch.waiting = true;
+      batch.retry_at =
+          now + std::chrono::milliseconds(static_cast<int64_t>(delay_ms));
+      stats_.retries++;
+      ++it;
+      continue;
+    } else {
+      LogMessage("ERROR: BulkWriter gave up on a batch of %d operations "
+                 "after %d attempts: %d (%s).",
+                 static_cast<int>(batch.operations.size()), batch.attempts,
+                 error, batch.commit.error_message());
+      stats_.operations_failed += batch.operations.size();
+      stats_.batches_failed++;
+    }
+    it = in_flight_.erase(it);
+  }
+  if (started_) {
+    stats_.seconds = std::chrono::duration<double>(now - start_).count();
+  }
+}
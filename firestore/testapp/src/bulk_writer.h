@@ -0,0 +1,131 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_BULK_WRITER_H_  // NOLINT
+#define FIREBASE_TESTAPP_BULK_WRITER_H_  // NOLINT
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <vector>
+
+#include "firebase/firestore.h"
+#include "firebase/future.h"
+
+struct BulkWriterOptions {
+  // Operations per WriteBatch. Firestore accepts at most 500.
+  int batch_size = 500;
+  // Batches committing at once. Adding an operation waits while this many
+  // are in flight.
+  int max_in_flight = 4;
+  // Commits of a batch that fails with a transient error (e.g. Unavailable)
+  // before it is given up on, and the delay before each retry, multiplied
+  // after each one.
+  int max_attempts = 5;
+  int initial_backoff_ms = 500;
+  double backoff_multiplier = 1.5;
+  int max_backoff_ms = 10000;
+};
+
+struct BulkWriterStats {
+  double documents_per_second() const {
+    return seconds > 0 ? operations_written / seconds : 0;
+  }
+
+  // Operations in batches that were committed, and those in batches that
+  // were given up on.
+  size_t operations_written = 0;
+  size_t operations_failed = 0;
+  size_t batches_committed = 0;
+  size_t batches_failed = 0;
+  // Commits that failed and were retried.
+  size_t retries = 0;
+  // Latency of each successful commit.
+  std::vector<double> commit_seconds;
+  // Time from the first operation until the last batch completed.
+  double seconds = 0;
+};
+
+// Writes an unbounded stream of operations, packing them into WriteBatches
+// and keeping several commits in flight at once, for bulk ingestion:
+//
+//   BulkWriter writer(firestore);
+//   for (...) writer.Set(collection.Document(id), data);
+//   if (!writer.Flush()) LogMessage("ERROR: ...");
+//
+// Each batch is atomic, but batches are independent of each other and may
+// complete in any order, so operations on the same document should go in the
+// same batch or be separated by a Flush(). A BulkWriter must be used from one
+// thread.
+class BulkWriter {
+ public:
+  explicit BulkWriter(firebase::firestore::Firestore* firestore,
+                      const BulkWriterOptions& options = BulkWriterOptions());
+  // Flushes any remaining operations.
+  ~BulkWriter();
+
+  void Set(const firebase::firestore::DocumentReference& document,
+           firebase::firestore::MapFieldValue data,
+           const firebase::firestore::SetOptions& options =
+               firebase::firestore::SetOptions());
+  void Update(const firebase::firestore::DocumentReference& document,
+              firebase::firestore::MapFieldValue data);
+  void Delete(const firebase::firestore::DocumentReference& document);
+
+  // Commits the partly filled batch, if any, and waits for every batch to
+  // complete. Returns false if any batch has been given up on.
+  bool Flush();
+
+  const BulkWriterStats& stats() const { return stats_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Operation {
+    enum Type { kSet, kUpdate, kDelete };
+    Type type;
+    firebase::firestore::DocumentReference document;
+    firebase::firestore::MapFieldValue data;
+    firebase::firestore::SetOptions options;
+  };
+
+  // The operations are kept until the batch succeeds, as a WriteBatch can
+  // only be committed once and retrying means building a new one.
+  struct Batch {
+    std::vector<Operation> operations;
+    firebase::Future<void> commit;
+    int attempts = 0;
+    Clock::time_point started;
+    // Set while the batch is backing off before its next attempt.
+    bool waiting = false;
+    Clock::time_point retry_at;
+  };
+
+  void Add(Operation operation);
+  // Commits the pending batch once there is room for it.
+  void Dispatch();
+  void Commit(Batch* batch);
+  // Retires completed batches and retries failed ones that are due.
+  void Poll();
+
+  firebase::firestore::Firestore* firestore_;
+  BulkWriterOptions options_;
+  std::vector<Operation> pending_;
+  std::list<Batch> in_flight_;
+  bool started_ = false;
+  Clock::time_point start_;
+  BulkWriterStats stats_;
+};
+
+#endif  // FIREBASE_TESTAPP_BULK_WRITER_H_  // NOLINT
@@ -0,0 +1,115 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "benchmarks.h"   // NOLINT
+#include "bulk_writer.h"  // NOLINT
+#include "firebase/firestore.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+std::string DocumentId(const char* prefix, int index) {
+  char id[64];
+  snprintf(id, sizeof(id), "%s_%06d", prefix, index);
+  return id;
+}
+
+// Writes num_documents documents named prefix_N to collection, and logs how
+// quickly they were written.
+bool WriteDocuments(firebase::firestore::Firestore* firestore,
+                    const firebase::firestore::CollectionReference& collection,
+                    const char* prefix, int num_documents, int document_bytes,
+                    const BulkWriterOptions& options) {
+  BulkWriter writer(firestore, options);
+  std::string text(document_bytes, 'x');
+  for (int i = 0; i < num_documents; i++) {
+    writer.Set(collection.Document(DocumentId(prefix, i)),
+               firebase::firestore::MapFieldValue{
+                   {"index", firebase::firestore::FieldValue::Integer(i)},
+                   {"text", firebase::firestore::FieldValue::String(text)}});
+  }
+  bool success = writer.Flush();
+  const BulkWriterStats& stats = writer.stats();
+  LogMessage(
+      "  %d in flight: %d documents in %.2f s, %.0f documents/s, %d batches, "
+      "%d retries, %d failed.",
+      options.max_in_flight, static_cast<int>(stats.operations_written),
+      stats.seconds, stats.documents_per_second(),
+      static_cast<int>(stats.batches_committed),
+      static_cast<int>(stats.retries),
+      static_cast<int>(stats.operations_failed));
+  LogLatencies("Commits", stats.commit_seconds);
+  return success;
+}
+
+bool DeleteDocuments(firebase::firestore::Firestore* firestore,
+                     const firebase::firestore::CollectionReference& collection,
+                     const char* prefix, int num_documents,
+                     const BulkWriterOptions& options) {
+  BulkWriter writer(firestore, options);
+  for (int i = 0; i < num_documents; i++) {
+    writer.Delete(collection.Document(DocumentId(prefix, i)));
+  }
+  return writer.Flush();
+}
+
+}  // namespace
+
+bool RunBulkWriterBenchmark(firebase::firestore::Firestore* firestore,
+                            int argc, const char* argv[]) {
+  int num_documents = 5000;
+  int document_bytes = 256;
+  BulkWriterOptions pipelined;
+  pipelined.max_in_flight = 8;
+  const char* documents_arg = GetArgument(argc, argv, "benchmark_documents");
+  if (documents_arg) num_documents = atoi(documents_arg);
+  const char* bytes_arg = GetArgument(argc, argv, "benchmark_document_bytes");
+  if (bytes_arg) document_bytes = atoi(bytes_arg);
+  const char* in_flight_arg = GetArgument(argc, argv, "benchmark_in_flight");
+  if (in_flight_arg) pipelined.max_in_flight = atoi(in_flight_arg);
+  if (num_documents <= 0 || document_bytes < 0 ||
+      pipelined.max_in_flight <= 0) {
+    LogMessage("ERROR: --benchmark_documents and --benchmark_in_flight must "
+               "be positive, and --benchmark_document_bytes not negative.");
+    return false;
+  }
+  LogMessage("Benchmarking BulkWriter with %d documents of %d bytes.",
+             num_documents, document_bytes);
+
+  firebase::firestore::CollectionReference collection =
+      firestore->Collection("benchmarks").Document().Collection("bulk");
+  BulkWriterOptions sequential;
+  sequential.max_in_flight = 1;
+  bool success = WriteDocuments(firestore, collection, "sequential",
+                                num_documents, document_bytes, sequential);
+  success = WriteDocuments(firestore, collection, "pipelined", num_documents,
+                           document_bytes, pipelined) &&
+            success;
+
+  success = DeleteDocuments(firestore, collection, "sequential",
+                            num_documents, pipelined) &&
+            success;
+  success = DeleteDocuments(firestore, collection, "pipelined", num_documents,
+                            pipelined) &&
+            success;
+  LogMessage(success ? "SUCCESS: BulkWriter benchmark complete."
+                     : "ERROR: BulkWriter benchmark failed.");
+  return success;
+}
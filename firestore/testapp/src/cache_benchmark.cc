@@ -0,0 +1,290 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"     // NOLINT
+#include "bulk_writer.h"    // NOLINT
+#include "firebase/app.h"
+#include "firebase/firestore.h"
+#include "firebase/future.h"
+#include "process_stats.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollMs = 1;
+const int64_t kMegabyte = 1024 * 1024;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double Megabytes(int64_t bytes) { return bytes / 1024.0 / 1024.0; }
+
+// Waits for future, and stores how long it took in seconds. Returns whether
+// it succeeded.
+template <typename T>
+bool Wait(const firebase::Future<T>& future, double* seconds) {
+  Clock::time_point start = Clock::now();
+  while (future.status() == firebase::kFutureStatusPending) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+  }
+  *seconds = SecondsSince(start);
+  return future.status() == firebase::kFutureStatusComplete &&
+         future.error() == firebase::firestore::kErrorOk;
+}
+
+// Parses a comma separated list of cache sizes in megabytes, where
+// "unlimited" stands for Settings::kCacheSizeUnlimited. Returns false if any
+// of them is invalid; Firestore doesn't accept caches under 1 MB.
+bool ParseCacheSizes(const char* list, std::vector<int64_t>* sizes) {
+  sizes->clear();
+  std::string text = list;
+  size_t start = 0;
+  while (start <= text.size()) {
+    size_t end = text.find(',', start);
+    if (end == std::string::npos) end = text.size();
+    std::string item = text.substr(start, end - start);
+    if (item == "unlimited") {
+      sizes->push_back(firebase::firestore::Settings::kCacheSizeUnlimited);
+    } else {
+      char* parsed_end = nullptr;
+      long megabytes = strtol(item.c_str(), &parsed_end, 10);  // NOLINT
+      if (item.empty() || *parsed_end != '\0' || megabytes < 1) return false;
+      sizes->push_back(megabytes * kMegabyte);
+    }
+    start = end + 1;
+  }
+  return !sizes->empty();
+}
+
+struct CacheConfig {
+  bool persistence = true;
+  int64_t cache_size_bytes = 0;
+};
+
+// Reads the benchmark collection with a Firestore instance of its own,
+// configured with config, and logs how the local cache performed.
+bool MeasureConfig(firebase::firestore::Firestore* firestore,
+                   const std::string& collection_path, int num_documents,
+                   const CacheConfig& config, int index, int num_reads,
+                   int gc_wait_seconds, const char* persistence_dir) {
+  char label[64];
+  if (config.cache_size_bytes ==
+      firebase::firestore::Settings::kCacheSizeUnlimited) {
+    snprintf(label, sizeof(label), "persistence %s, unlimited cache",
+             config.persistence ? "on" : "off");
+  } else {
+    snprintf(label, sizeof(label), "persistence %s, %d MB cache",
+             config.persistence ? "on" : "off",
+             static_cast<int>(config.cache_size_bytes / kMegabyte));
+  }
+  int64_t memory_baseline = GetResidentMemoryBytes();
+  int64_t disk_baseline =
+      persistence_dir ? GetDirectorySize(persistence_dir) : -1;
+
+  // Settings can only be changed before an instance is first used, so each
+  // configuration needs its own App.
+  char app_name[64];
+  snprintf(app_name, sizeof(app_name), "cache_benchmark_%d", index);
+  firebase::App* app;
+#if defined(__ANDROID__)
+  app = firebase::App::Create(firestore->app()->options(), app_name,
+                              GetJniEnv(), GetActivity());
+#else
+  app = firebase::App::Create(firestore->app()->options(), app_name);
+#endif  // defined(__ANDROID__)
+  firebase::firestore::Firestore* instance =
+      firebase::firestore::Firestore::GetInstance(app);
+  if (!instance) {
+    LogMessage("ERROR: Unable to create a Firestore instance for %s.", label);
+    delete app;
+    return false;
+  }
+  firebase::firestore::Settings settings = instance->settings();
+  settings.set_host(firestore->settings().host());
+  settings.set_ssl_enabled(firestore->settings().is_ssl_enabled());
+  settings.set_persistence_enabled(config.persistence);
+  settings.set_cache_size_bytes(config.cache_size_bytes);
+  instance->set_settings(settings);
+  firebase::firestore::CollectionReference collection =
+      instance->Collection(collection_path);
+
+  bool success = true;
+  double seconds = 0;
+  firebase::Future<firebase::firestore::QuerySnapshot> load =
+      collection.Get(firebase::firestore::Source::kServer);
+  success = Wait(load, &seconds) && load.result()->size() ==
+                                        static_cast<size_t>(num_documents);
+  double load_seconds = seconds;
+
+  std::vector<double> server;
+  std::vector<double> cache;
+  size_t cached = 0;
+  for (int i = 0; i < num_reads && success; i++) {
+    success = Wait(collection.Get(firebase::firestore::Source::kServer),
+                   &seconds);
+    server.push_back(seconds);
+    firebase::Future<firebase::firestore::QuerySnapshot> from_cache =
+        collection.Get(firebase::firestore::Source::kCache);
+    success = Wait(from_cache, &seconds) && success;
+    cache.push_back(seconds);
+    if (success) cached = from_cache.result()->size();
+  }
+  int64_t memory = GetResidentMemoryBytes();
+  int64_t disk = persistence_dir ? GetDirectorySize(persistence_dir) : -1;
+
+  // Firestore only collects garbage from the cache a while after it starts,
+  // and then every few minutes, so eviction can only be seen by waiting.
+  int cached_after_gc = -1;
+  if (success && gc_wait_seconds > 0) {
+    Clock::time_point start = Clock::now();
+    while (SecondsSince(start) < gc_wait_seconds) {
+      if (ProcessEvents(100)) break;
+    }
+    firebase::Future<firebase::firestore::QuerySnapshot> from_cache =
+        collection.Get(firebase::firestore::Source::kCache);
+    if (Wait(from_cache, &seconds)) {
+      cached_after_gc = static_cast<int>(from_cache.result()->size());
+    }
+  }
+
+  char memory_text[32] = "unknown";
+  char disk_text[32] = "unknown";
+  char gc_text[64] = "";
+  if (memory >= 0 && memory_baseline >= 0) {
+    snprintf(memory_text, sizeof(memory_text), "%+.2f MB",
+             Megabytes(memory - memory_baseline));
+  }
+  if (disk >= 0 && disk_baseline >= 0) {
+    snprintf(disk_text, sizeof(disk_text), "%+.2f MB",
+             Megabytes(disk - disk_baseline));
+  }
+  if (cached_after_gc >= 0) {
+    snprintf(gc_text, sizeof(gc_text), ", %d after waiting %d s",
+             cached_after_gc, gc_wait_seconds);
+  }
+  LogMessage("  %s: loaded in %.2f s, memory %s, disk %s, %d of %d documents "
+             "cached%s.",
+             label, load_seconds, memory_text, disk_text,
+             static_cast<int>(cached), num_documents, gc_text);
+  LogLatencies("Server query", server);
+  LogLatencies("Cache query", cache);
+  if (!success) LogMessage("ERROR: Reads failed with %s.", label);
+
+  // Leave nothing behind for the next configuration to find.
+  success = Wait(instance->Terminate(), &seconds) && success;
+  if (config.persistence) {
+    success = Wait(instance->ClearPersistence(), &seconds) && success;
+  }
+  delete instance;
+  delete app;
+  return success;
+}
+
+}  // namespace
+
+bool RunCacheBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                       const char* argv[]) {
+  int num_documents = 2000;
+  int document_bytes = 1024;
+  int num_reads = 10;
+  int gc_wait_seconds = 0;
+  std::vector<int64_t> cache_sizes;
+  const char* documents_arg = GetArgument(argc, argv, "benchmark_documents");
+  if (documents_arg) num_documents = atoi(documents_arg);
+  const char* bytes_arg = GetArgument(argc, argv, "benchmark_document_bytes");
+  if (bytes_arg) document_bytes = atoi(bytes_arg);
+  const char* reads_arg = GetArgument(argc, argv, "benchmark_reads");
+  if (reads_arg) num_reads = atoi(reads_arg);
+  const char* gc_arg = GetArgument(argc, argv, "benchmark_gc_wait_seconds");
+  if (gc_arg) gc_wait_seconds = atoi(gc_arg);
+  const char* sizes_arg = GetArgument(argc, argv, "benchmark_cache_sizes_mb");
+  const char* persistence_dir =
+      GetArgument(argc, argv, "benchmark_persistence_dir");
+  if (num_documents <= 0 || document_bytes <= 0 || num_reads <= 0 ||
+      gc_wait_seconds < 0) {
+    LogMessage("ERROR: --benchmark_documents, --benchmark_document_bytes and "
+               "--benchmark_reads must be positive, and "
+               "--benchmark_gc_wait_seconds can't be negative.");
+    return false;
+  }
+  if (!ParseCacheSizes(sizes_arg ? sizes_arg : "1,10,100,unlimited",
+                       &cache_sizes)) {
+    LogMessage("ERROR: --benchmark_cache_sizes_mb must be a comma separated "
+               "list of sizes of at least 1, or \"unlimited\".");
+    return false;
+  }
+  LogMessage("Benchmarking the local cache with %d documents of %d bytes.",
+             num_documents, document_bytes);
+  if (persistence_dir && GetDirectorySize(persistence_dir) < 0) {
+    LogMessage("  Unable to read %s, not measuring persistence.",
+               persistence_dir);
+    persistence_dir = nullptr;
+  }
+
+  firebase::firestore::CollectionReference collection =
+      firestore->Collection("benchmarks").Document().Collection("cache");
+  std::vector<firebase::firestore::DocumentReference> documents;
+  bool success;
+  {
+    BulkWriter writer(firestore);
+    std::string text(document_bytes, 'x');
+    for (int i = 0; i < num_documents; i++) {
+      documents.push_back(collection.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"index", firebase::firestore::FieldValue::Integer(i)},
+                     {"text", firebase::firestore::FieldValue::String(text)}});
+    }
+    success = writer.Flush();
+  }
+  if (!success) {
+    LogMessage("ERROR: Unable to write the benchmark data.");
+    return false;
+  }
+
+  int index = 0;
+  for (bool persistence : {true, false}) {
+    for (int64_t cache_size : cache_sizes) {
+      CacheConfig config;
+      config.persistence = persistence;
+      config.cache_size_bytes = cache_size;
+      success = MeasureConfig(firestore, collection.path(), num_documents,
+                              config, index++, num_reads, gc_wait_seconds,
+                              persistence_dir) &&
+                success;
+    }
+  }
+
+  {
+    BulkWriter writer(firestore);
+    for (const auto& document : documents) writer.Delete(document);
+    success = writer.Flush() && success;
+  }
+  LogMessage(success ? "SUCCESS: Cache benchmark complete."
+                     : "ERROR: Cache benchmark failed.");
+  return success;
+}
@@ -0,0 +1,191 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "collection_scanner.h"  // NOLINT
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "firebase/future.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollMs = 1;
+// The characters of automatically generated document IDs, in byte order.
+const char kAutoIdAlphabet[] =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+const int kAutoIdAlphabetSize = sizeof(kAutoIdAlphabet) - 1;
+
+// Hands documents from the range readers to the consumer.
+class DocumentQueue {
+ public:
+  DocumentQueue(size_t capacity, int producers)
+      : capacity_(capacity), producers_(producers) {}
+
+  // Adds a document, waiting while the queue is full. Returns whether it had
+  // to wait.
+  bool Push(const firebase::firestore::DocumentSnapshot& document) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool waited = documents_.size() >= capacity_;
+    not_full_.wait(lock, [this]() { return documents_.size() < capacity_; });
+    documents_.push_back(document);
+    lock.unlock();
+    not_empty_.notify_one();
+    return waited;
+  }
+
+  // Takes the next document, waiting for one. Returns false once the queue
+  // is empty and every producer is done.
+  bool Pop(firebase::firestore::DocumentSnapshot* document) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock,
+                    [this]() { return !documents_.empty() || !producers_; });
+    if (documents_.empty()) return false;
+    *document = documents_.front();
+    documents_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void ProducerDone() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      producers_--;
+    }
+    not_empty_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<firebase::firestore::DocumentSnapshot> documents_;
+  size_t capacity_;
+  int producers_;
+};
+
+struct RangeCounters {
+  std::atomic<size_t> pages{0};
+  std::atomic<size_t> full_queue_waits{0};
+  std::atomic<int> failed_ranges{0};
+};
+
+// Reads the documents with IDs from start up to but not including end, where
+// an empty string leaves that side open, a page at a time. Each page starts
+// after the last document of the previous one, so that no query sets its
+// start twice.
+void ReadRange(const firebase::firestore::Query& query,
+               const std::string& start, const std::string& end,
+               int page_size, DocumentQueue* queue, RangeCounters* counters) {
+  firebase::firestore::Query range =
+      query.OrderBy(firebase::firestore::FieldPath::DocumentId());
+  if (!end.empty()) {
+    range = range.EndBefore({firebase::firestore::FieldValue::String(end)});
+  }
+  firebase::firestore::Query page =
+      start.empty()
+          ? range
+          : range.StartAt({firebase::firestore::FieldValue::String(start)});
+  while (true) {
+    firebase::Future<firebase::firestore::QuerySnapshot> future =
+        page.Limit(page_size).Get();
+    while (future.status() == firebase::kFutureStatusPending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+    counters->pages++;
+    if (future.status() != firebase::kFutureStatusComplete ||
+        future.error() != firebase::firestore::kErrorOk) {
+      LogMessage("ERROR: Scan of IDs from \"%s\" to \"%s\" failed: %d (%s).",
+                 start.c_str(), end.c_str(), future.error(),
+                 future.error_message());
+      counters->failed_ranges++;
+      break;
+    }
+    std::vector<firebase::firestore::DocumentSnapshot> documents =
+        future.result()->documents();
+    for (const auto& document : documents) {
+      if (queue->Push(document)) counters->full_queue_waits++;
+    }
+    if (documents.size() < static_cast<size_t>(page_size)) break;
+    page = range.StartAfter(documents.back());
+  }
+  queue->ProducerDone();
+}
+
+}  // namespace
+
+std::vector<std::string> AutoIdSplitPoints(int partitions) {
+  // Split on the first two characters, which is fine grained enough for
+  // thousands of partitions.
+  const int kPrefixes = kAutoIdAlphabetSize * kAutoIdAlphabetSize;
+  std::vector<std::string> split_points;
+  for (int i = 1; i < partitions; i++) {
+    int prefix = static_cast<int>(static_cast<int64_t>(i) * kPrefixes /
+                                  partitions);
+    std::string point;
+    point += kAutoIdAlphabet[prefix / kAutoIdAlphabetSize];
+    point += kAutoIdAlphabet[prefix % kAutoIdAlphabetSize];
+    if (split_points.empty() || split_points.back() != point) {
+      split_points.push_back(point);
+    }
+  }
+  return split_points;
+}
+
+bool ScanCollection(const firebase::firestore::Query& query,
+                    const std::vector<std::string>& split_points,
+                    const ScanOptions& options,
+                    const std::function<void(
+                        const firebase::firestore::DocumentSnapshot&)>&
+                        consumer,
+                    ScanStats* stats) {
+  *stats = ScanStats();
+  Clock::time_point start = Clock::now();
+  int ranges = static_cast<int>(split_points.size()) + 1;
+  DocumentQueue queue(options.queue_capacity > 0 ? options.queue_capacity : 1,
+                      ranges);
+  RangeCounters counters;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < ranges; i++) {
+    std::string range_start = i > 0 ? split_points[i - 1] : std::string();
+    std::string range_end = i < ranges - 1 ? split_points[i] : std::string();
+    readers.emplace_back(ReadRange, query, range_start, range_end,
+                         std::max(options.page_size, 1), &queue, &counters);
+  }
+
+  firebase::firestore::DocumentSnapshot document;
+  while (queue.Pop(&document)) {
+    consumer(document);
+    stats->documents++;
+  }
+  for (std::thread& reader : readers) reader.join();
+
+  stats->pages = counters.pages;
+  stats->full_queue_waits = counters.full_queue_waits;
+  stats->failed_ranges = counters.failed_ranges;
+  stats->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return stats->failed_ranges == 0;
+}
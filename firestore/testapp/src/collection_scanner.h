@@ -0,0 +1,71 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_COLLECTION_SCANNER_H_  // NOLINT
+#define FIREBASE_TESTAPP_COLLECTION_SCANNER_H_  // NOLINT
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "firebase/firestore.h"
+
+struct ScanOptions {
+  // Documents fetched by each query within a range.
+  int page_size = 500;
+  // Documents waiting for the consumer before the readers stop fetching.
+  size_t queue_capacity = 2000;
+};
+
+struct ScanStats {
+  double documents_per_second() const {
+    return seconds > 0 ? documents / seconds : 0;
+  }
+
+  size_t documents = 0;
+  // Queries issued across all the partitions.
+  size_t pages = 0;
+  // Ranges that stopped early because a query failed.
+  int failed_ranges = 0;
+  // Times a reader waited for the consumer to make room in the queue.
+  size_t full_queue_waits = 0;
+  double seconds = 0;
+};
+
+// Returns partitions - 1 document IDs that split the keyspace of
+// automatically generated IDs, which are spread uniformly over [0-9A-Za-z],
+// into partitions ranges of about the same number of documents. Collections
+// with IDs chosen by the app should supply split points of their own.
+std::vector<std::string> AutoIdSplitPoints(int partitions);
+
+// Reads every document matched by query, which must have no ordering and no
+// inequality filters, by splitting the document IDs into ranges at
+// split_points (see AutoIdSplitPoints()) and reading the ranges concurrently,
+// each on its own thread, a page at a time, ordered by
+// FieldPath::DocumentId().
+//
+// The documents are handed to consumer on the calling thread through a
+// bounded queue, so a slow consumer holds back the readers instead of letting
+// the documents pile up. They arrive in order within each range, but ranges
+// are interleaved. Returns false if any range couldn't be read completely.
+bool ScanCollection(const firebase::firestore::Query& query,
+                    const std::vector<std::string>& split_points,
+                    const ScanOptions& options,
+                    const std::function<void(
+                        const firebase::firestore::DocumentSnapshot&)>&
+                        consumer,
+                    ScanStats* stats);
+
+#endif  // FIREBASE_TESTAPP_COLLECTION_SCANNER_H_  // NOLINT
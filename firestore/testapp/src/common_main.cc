@@ -13,34 +13,96 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "firebase/auth.h"
 #include "firebase/auth/user.h"
 #include "firebase/firestore.h"
 #include "firebase/util.h"
 
+#include "admission_controller.h"      // NOLINT
+#include "benchmarks.h"                // NOLINT
+#include "bulk_writer.h"               // NOLINT
+#include "collection_scanner.h"        // NOLINT
+#include "document_builder.h"          // NOLINT
+#include "document_cache.h"            // NOLINT
+#include "instrumented_transaction.h"  // NOLINT
+#include "merged_query.h"              // NOLINT
+#include "query_aggregator.h"          // NOLINT
+#include "query_iterator.h"            // NOLINT
 // Thin OS abstraction layer.
 #include "main.h"  // NOLINT
 
+using Clock = std::chrono::steady_clock;
+
+// Default deadline of a wait, from when it starts.
 const int kTimeoutMs = 5000;
-const int kSleepMs = 100;
+// Longest a wait goes without letting the platform process its events.
+const int kEventPollMs = 100;
+
+// Waits on condition, with lock held, until done() returns true or deadline
+// passes, and returns done(). Notifying condition ends the wait at once;
+// every kEventPollMs in between the lock is released to process events.
+template <typename Predicate>
+bool WaitUntil(std::unique_lock<std::mutex>* lock,
+               std::condition_variable* condition, Clock::time_point deadline,
+               Predicate done) {
+  while (!done()) {
+    Clock::time_point now = Clock::now();
+    if (now >= deadline) return false;
+    Clock::time_point wake =
+        std::min(deadline, now + std::chrono::milliseconds(kEventPollMs));
+    if (condition->wait_until(*lock, wake, done)) break;
+    lock->unlock();
+    ProcessEvents(0);
+    lock->lock();
+  }
+  return true;
+}
+
+// Signaled by a Future's completion callback. Shared with the callback, which
+// may run after a timed out wait has returned.
+struct Completion {
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool done = false;
+};
 
 // Waits for a Future to be completed and returns whether the future has
 // completed successfully. If the Future returns an error, it will be logged.
-bool Await(const firebase::FutureBase& future, const char* name) {
-  int remaining_timeout = kTimeoutMs;
-  while (future.status() == firebase::kFutureStatusPending &&
-         remaining_timeout > 0) {
-    remaining_timeout -= kSleepMs;
-    ProcessEvents(kSleepMs);
+// The wait ends as soon as the Future completes, through its OnCompletion()
+// callback, so this replaces any callback already set on it.
+bool Await(const firebase::FutureBase& future, const char* name,
+           int timeout_ms = kTimeoutMs) {
+  if (future.status() == firebase::kFutureStatusPending) {
+    auto completion = std::make_shared<Completion>();
+    future.OnCompletion([completion](const firebase::FutureBase&) {
+      {
+        std::lock_guard<std::mutex> lock(completion->mutex);
+        completion->done = true;
+      }
+      completion->condition.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(completion->mutex);
+    WaitUntil(&lock, &completion->condition,
+              Clock::now() + std::chrono::milliseconds(timeout_ms),
+              [&completion]() { return completion->done; });
   }
 
-  if (future.status() != firebase::kFutureStatusComplete) {
+  if (future.status() == firebase::kFutureStatusPending) {
+    LogMessage("ERROR: %s timed out after %d ms.", name, timeout_ms);
+    return false;
+  } else if (future.status() != firebase::kFutureStatusComplete) {
     LogMessage("ERROR: %s returned an invalid result.", name);
     return false;
   } else if (future.error() != 0) {
@@ -51,11 +113,35 @@ bool Await(const firebase::FutureBase& future, const char* name) {
   return true;
 }
 
+// Counts events delivered on another thread, and wakes any thread waiting for
+// them.
 class Countable {
  public:
-  int event_count() const { return event_count_; }
+  int event_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return event_count_;
+  }
+
+  // Waits until at least count events have arrived, or deadline passes.
+  // Returns whether they arrived.
+  bool WaitForEvents(int count, Clock::time_point deadline) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return WaitUntil(&lock, &condition_, deadline,
+                     [this, count]() { return event_count_ >= count; });
+  }
 
  protected:
+  void CountEvent() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      event_count_++;
+    }
+    condition_.notify_all();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  mutable std::condition_variable condition_;
   int event_count_ = 0;
 };
 
@@ -67,11 +153,11 @@ class TestEventListener : public Countable {
   void OnEvent(const T& value,
                const firebase::firestore::Error error_code,
                const std::string& error_message) {
-    event_count_++;
     if (error_code != firebase::firestore::kErrorOk) {
       LogMessage("ERROR: EventListener %s got %d (%s).", name_.c_str(),
                  error_code, error_message.c_str());
     }
+    CountEvent();
   }
 
   template <typename U>
@@ -87,17 +173,55 @@ class TestEventListener : public Countable {
   std::string name_;
 };
 
-void Await(const Countable& listener, const char* name) {
-  int remaining_timeout = kTimeoutMs;
-  while (listener.event_count() && remaining_timeout > 0) {
-    remaining_timeout -= kSleepMs;
-    ProcessEvents(kSleepMs);
-  }
-  if (remaining_timeout <= 0) {
+// Counts calls to Count(), e.g. from a callback run by Firestore.
+class EventCounter : public Countable {
+ public:
+  void Count() { CountEvent(); }
+};
+
+// Waits for listener to receive at least min_events events.
+void Await(const Countable& listener, const char* name, int min_events = 1,
+           int timeout_ms = kTimeoutMs) {
+  if (!listener.WaitForEvents(
+          min_events, Clock::now() + std::chrono::milliseconds(timeout_ms))) {
     LogMessage("ERROR: %s listener timed out.", name);
   }
 }
 
+const char* GetArgument(int argc, const char* argv[], const char* name) {
+  size_t name_length = strlen(name);
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--", 2) == 0 &&
+        strncmp(arg + 2, name, name_length) == 0 &&
+        arg[2 + name_length] == '=') {
+      return arg + 2 + name_length + 1;
+    }
+  }
+  return nullptr;
+}
+
+// Runs the benchmark given by "--benchmark=name".
+bool RunBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                  const char* argv[]) {
+  const char* name = GetArgument(argc, argv, "benchmark");
+  if (strcmp(name, "builder") == 0) {
+    return RunDocumentBuilderBenchmark(firestore, argc, argv);
+  } else if (strcmp(name, "bulk") == 0) {
+    return RunBulkWriterBenchmark(firestore, argc, argv);
+  } else if (strcmp(name, "cache") == 0) {
+    return RunCacheBenchmark(firestore, argc, argv);
+  } else if (strcmp(name, "listeners") == 0) {
+    return RunListenerBenchmark(firestore, argc, argv);
+  } else if (strcmp(name, "merge") == 0) {
+    return RunMergedQueryBenchmark(firestore, argc, argv);
+  } else if (strcmp(name, "scan") == 0) {
+    return RunScanBenchmark(firestore, argc, argv);
+  }
+  LogMessage("ERROR: Unknown benchmark %s.", name);
+  return false;
+}
+
 extern "C" int common_main(int argc, const char* argv[]) {
   firebase::App* app;
 
@@ -176,9 +300,25 @@ extern "C" int common_main(int argc, const char* argv[]) {
   }
 
   firebase::firestore::Settings settings = firestore->settings();
+  // "--firestore_emulator=host:port" connects to the Firestore emulator.
+  const char* emulator = GetArgument(argc, argv, "firestore_emulator");
+  if (emulator) {
+    settings.set_host(emulator);
+    settings.set_ssl_enabled(false);
+    LogMessage("Using the Firestore emulator at %s.", emulator);
+  }
   firestore->set_settings(settings);
   LogMessage("Successfully set Firestore settings.");
 
+  // "--benchmark=name" runs a benchmark instead of the tests.
+  if (GetArgument(argc, argv, "benchmark")) {
+    bool success = RunBenchmark(firestore, argc, argv);
+    delete firestore;
+    delete auth;
+    delete app;
+    return success ? 0 : 1;
+  }
+
   LogMessage("Testing non-wrapping types.");
   const firebase::Timestamp timestamp{1, 2};
   if (timestamp.seconds() != 1 || timestamp.nanoseconds() != 2) {
@@ -294,6 +434,414 @@ extern "C" int common_main(int argc, const char* argv[]) {
         "firestore.RunTransaction");
   LogMessage("Tested transaction.");
 
+  LogMessage("Testing instrumented transaction.");
+  {
+    TransactionBackoff backoff;
+    TransactionStats stats;
+    std::string error_message;
+    firebase::firestore::DocumentReference counter =
+        collection.Document("counter");
+    firebase::firestore::Error error = RunInstrumentedTransaction(
+        firestore,
+        [counter](firebase::firestore::Transaction& transaction,
+                  std::string& message) -> firebase::firestore::Error {
+          firebase::firestore::Error error = firebase::firestore::kErrorOk;
+          firebase::firestore::DocumentSnapshot snapshot =
+              transaction.Get(counter, &error, &message);
+          if (error != firebase::firestore::kErrorOk) return error;
+          int64_t count = snapshot.exists()
+                              ? snapshot.Get("count").integer_value()
+                              : 0;
+          transaction.Set(
+              counter,
+              firebase::firestore::MapFieldValue{
+                  {"count",
+                   firebase::firestore::FieldValue::Integer(count + 1)}});
+          return firebase::firestore::kErrorOk;
+        },
+        backoff, &stats, &error_message);
+    LogTransactionStats("Increment", stats);
+    if (error != firebase::firestore::kErrorOk || !stats.committed ||
+        stats.attempts < 1) {
+      LogMessage("ERROR: instrumented transaction failed with %d (%s).", error,
+                 error_message.c_str());
+    }
+
+    error = RunInstrumentedTransaction(
+        firestore,
+        [](firebase::firestore::Transaction&,
+           std::string& message) -> firebase::firestore::Error {
+          message = "Aborted by the test.";
+          return firebase::firestore::kErrorCancelled;
+        },
+        backoff, &stats, &error_message);
+    LogTransactionStats("Abort", stats);
+    if (error == firebase::firestore::kErrorOk || stats.committed ||
+        stats.user_aborts != 1 || stats.runs != 1) {
+      LogMessage("ERROR: aborted instrumented transaction returned %d.", error);
+    }
+    Await(counter.Delete(), "counter.Delete");
+  }
+  LogMessage("Tested instrumented transaction.");
+
+  LogMessage("Testing admission controller.");
+  {
+    const int kWrites = 20;
+    const int kLimit = 4;
+    AdmissionOptions options;
+    options.initial_limit = kLimit;
+    options.max_limit = kLimit;
+    AdmissionController controller(options);
+    firebase::firestore::CollectionReference admission =
+        firestore->Collection("admission");
+    std::vector<firebase::Future<void>> writes;
+    int max_in_flight = 0;
+    for (int i = 0; i < kWrites; i++) {
+      writes.push_back(AdmittedSet(
+          &controller, admission.Document(std::to_string(i)),
+          firebase::firestore::MapFieldValue{
+              {"value", firebase::firestore::FieldValue::Integer(i)}}));
+      max_in_flight = std::max(max_in_flight, controller.gauges().in_flight);
+    }
+    controller.Drain();
+    bool written = true;
+    for (const auto& write : writes) {
+      written = written && write.status() == firebase::kFutureStatusComplete &&
+                write.error() == firebase::firestore::kErrorOk;
+    }
+    AdmissionGauges gauges = controller.gauges();
+    LogMessage("Limit %d, %d admitted, %d completed, %.1f ms latency.",
+               gauges.limit, static_cast<int>(gauges.admitted),
+               static_cast<int>(gauges.completed), gauges.latency_ms);
+    if (!written || gauges.completed != kWrites) {
+      LogMessage("ERROR: admitted writes failed.");
+    } else if (max_in_flight > kLimit) {
+      LogMessage("ERROR: %d writes were in flight, over the limit of %d.",
+                 max_in_flight, kLimit);
+    }
+    firebase::firestore::WriteBatch cleanup = firestore->batch();
+    for (int i = 0; i < kWrites; i++) {
+      cleanup.Delete(admission.Document(std::to_string(i)));
+    }
+    Await(cleanup.Commit(), "admission cleanup");
+  }
+  LogMessage("Tested admission controller.");
+
+  LogMessage("Testing document builder.");
+  {
+    DocumentBuilder builder;
+    const int kName = builder.Field("name");
+    const int kCount = builder.Field("count");
+    builder.Set(kName, firebase::firestore::FieldValue::String("first"))
+        .Set(kCount, firebase::firestore::FieldValue::Integer(1));
+    const firebase::firestore::MapFieldValue& first = builder.Build();
+    if (first.size() != 2 || first.at("name").string_value() != "first" ||
+        first.at("count").integer_value() != 1) {
+      LogMessage("ERROR: document builder built the wrong fields.");
+    }
+    builder.Reset();
+    builder.Set(kName, firebase::firestore::FieldValue::String("second"));
+    const firebase::firestore::MapFieldValue& second = builder.Build();
+    if (second.size() != 1 || second.at("name").string_value() != "second") {
+      LogMessage("ERROR: document builder kept a field that wasn't set.");
+    }
+    auto document = collection.Document("built");
+    Await(document.Set(builder.Build()), "document.Set built");
+    Await(document.Delete(), "document.Delete built");
+    if (builder.Field("count") != kCount) {
+      LogMessage("ERROR: document builder interned a field name twice.");
+    }
+  }
+  LogMessage("Tested document builder.");
+
+  LogMessage("Testing bulk writer.");
+  {
+    const int kDocuments = 25;
+    BulkWriterOptions options;
+    options.batch_size = 10;
+    options.max_in_flight = 2;
+    firebase::firestore::CollectionReference bulk =
+        firestore->Collection("bulk");
+    {
+      BulkWriter writer(firestore, options);
+      for (int i = 0; i < kDocuments; i++) {
+        writer.Set(bulk.Document(std::to_string(i)),
+                   firebase::firestore::MapFieldValue{
+                       {"value", firebase::firestore::FieldValue::Integer(i)}});
+      }
+      bool flushed = writer.Flush();
+      const BulkWriterStats& stats = writer.stats();
+      LogMessage("Wrote %d documents in %d batches, %.0f documents/s.",
+                 static_cast<int>(stats.operations_written),
+                 static_cast<int>(stats.batches_committed),
+                 stats.documents_per_second());
+      if (!flushed || stats.operations_written != kDocuments ||
+          stats.batches_committed != 3) {
+        LogMessage("ERROR: bulk writer didn't write every document.");
+      }
+    }
+    auto written = bulk.Get();
+    if (Await(written, "bulk.Get") &&
+        written.result()->size() != static_cast<size_t>(kDocuments)) {
+      LogMessage("ERROR: bulk writer wrote %d documents, expected %d.",
+                 static_cast<int>(written.result()->size()), kDocuments);
+    }
+    BulkWriter cleanup(firestore, options);
+    for (int i = 0; i < kDocuments; i++) {
+      cleanup.Delete(bulk.Document(std::to_string(i)));
+    }
+    if (!cleanup.Flush()) {
+      LogMessage("ERROR: bulk writer didn't delete every document.");
+    }
+  }
+  LogMessage("Tested bulk writer.");
+
+  LogMessage("Testing collection scan.");
+  {
+    const int kDocuments = 30;
+    firebase::firestore::CollectionReference scan =
+        firestore->Collection("scan");
+    std::vector<firebase::firestore::DocumentReference> documents;
+    BulkWriter writer(firestore);
+    for (int i = 0; i < kDocuments; i++) {
+      documents.push_back(scan.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"index", firebase::firestore::FieldValue::Integer(i)}});
+    }
+    writer.Flush();
+
+    ScanOptions options;
+    options.page_size = 5;
+    ScanStats stats;
+    std::vector<std::string> ids;
+    bool scanned = ScanCollection(
+        scan, AutoIdSplitPoints(4), options,
+        [&ids](const firebase::firestore::DocumentSnapshot& document) {
+          ids.push_back(document.id());
+        },
+        &stats);
+    std::sort(ids.begin(), ids.end());
+    LogMessage("Scanned %d documents in %d pages.",
+               static_cast<int>(stats.documents),
+               static_cast<int>(stats.pages));
+    if (!scanned || ids.size() != kDocuments ||
+        std::unique(ids.begin(), ids.end()) != ids.end()) {
+      LogMessage("ERROR: collection scan didn't read every document once.");
+    }
+    for (const auto& document : documents) writer.Delete(document);
+    writer.Flush();
+  }
+  LogMessage("Tested collection scan.");
+
+  LogMessage("Testing query iterator.");
+  {
+    const int kDocuments = 23;
+    firebase::firestore::CollectionReference pages =
+        firestore->Collection("pages");
+    std::vector<firebase::firestore::DocumentReference> documents;
+    BulkWriter writer(firestore);
+    for (int i = 0; i < kDocuments; i++) {
+      documents.push_back(pages.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"index", firebase::firestore::FieldValue::Integer(i)}});
+    }
+    writer.Flush();
+
+    QueryIterator iterator(pages.OrderBy("index"), 5);
+    firebase::firestore::DocumentSnapshot snapshot;
+    int64_t expected = 0;
+    while (iterator.Next(&snapshot)) {
+      if (snapshot.Get("index").integer_value() != expected) {
+        LogMessage("ERROR: query iterator returned document %d out of order.",
+                   static_cast<int>(expected));
+      }
+      expected++;
+    }
+    LogMessage("Iterated over %d documents in %d pages.",
+               static_cast<int>(iterator.documents_read()),
+               static_cast<int>(iterator.pages_read()));
+    if (iterator.error() != firebase::firestore::kErrorOk) {
+      LogMessage("ERROR: query iterator failed: %d (%s).", iterator.error(),
+                 iterator.error_message().c_str());
+    } else if (expected != kDocuments) {
+      LogMessage("ERROR: query iterator read %d documents, expected %d.",
+                 static_cast<int>(expected), kDocuments);
+    }
+    for (const auto& document : documents) writer.Delete(document);
+    writer.Flush();
+  }
+  LogMessage("Tested query iterator.");
+
+  LogMessage("Testing query aggregator.");
+  {
+    firebase::firestore::CollectionReference sales =
+        firestore->Collection("aggregation");
+    const char* kRegions[] = {"east", "west", "east", "west", "east"};
+    const int kAmounts[] = {10, 20, 30, 40, 50};
+    std::vector<firebase::firestore::DocumentReference> documents;
+    BulkWriter writer(firestore);
+    for (int i = 0; i < 5; i++) {
+      documents.push_back(sales.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"region",
+                      firebase::firestore::FieldValue::String(kRegions[i])},
+                     {"amount",
+                      firebase::firestore::FieldValue::Integer(kAmounts[i])}});
+    }
+    writer.Flush();
+
+    QueryAggregator scanned("amount", "region");
+    if (scanned.AddAll(sales, 2) != firebase::firestore::kErrorOk) {
+      LogMessage("ERROR: query aggregator couldn't read the documents.");
+    }
+    AggregateResult east = scanned.group("east");
+    AggregateResult total = scanned.total();
+    LogMessage("Aggregated %d documents, sum %.0f, east average %.0f.",
+               static_cast<int>(total.documents), total.sum, east.average());
+    if (total.count != 5 || total.sum != 150 || east.count != 3 ||
+        east.min != 10 || east.max != 50 || east.average() != 30) {
+      LogMessage("ERROR: query aggregator computed the wrong aggregates.");
+    }
+
+    // Keep a second aggregator up to date with a listener, and check that
+    // changes and removals are taken back out of it.
+    QueryAggregator live("amount", "region");
+    EventCounter updates;
+    firebase::firestore::ListenerRegistration registration = live.Listen(
+        sales, [&updates](const QueryAggregator&) { updates.Count(); });
+    Await(updates, "aggregation", 1);
+    Await(documents[4].Update(firebase::firestore::MapFieldValue{
+              {"amount", firebase::firestore::FieldValue::Integer(5)}}),
+          "aggregation update");
+    Await(documents[1].Delete(), "aggregation delete");
+    Await(updates, "aggregation", 3);
+    east = live.group("east");
+    AggregateResult west = live.group("west");
+    if (east.sum != 45 || east.max != 30 || east.min != 5 || west.count != 1 ||
+        west.sum != 40 || live.total().documents != 4) {
+      LogMessage("ERROR: query aggregator didn't apply the changes.");
+    }
+    registration.Remove();
+    for (const auto& document : documents) writer.Delete(document);
+    writer.Flush();
+  }
+  LogMessage("Tested query aggregator.");
+
+  LogMessage("Testing merged query.");
+  {
+    firebase::firestore::CollectionReference scores =
+        firestore->Collection("merged");
+    std::vector<firebase::firestore::DocumentReference> documents;
+    BulkWriter writer(firestore);
+    for (int i = 0; i < 10; i++) {
+      documents.push_back(scores.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"score", firebase::firestore::FieldValue::Integer(i)}});
+    }
+    writer.Flush();
+
+    // Scores 0-5 or 4-9, highest first, so 4 and 5 are matched twice.
+    MergedQuery merged(
+        {scores.WhereLessThan("score",
+                              firebase::firestore::FieldValue::Integer(6)),
+         scores.WhereGreaterThanOrEqualTo(
+             "score", firebase::firestore::FieldValue::Integer(4))},
+        "score", firebase::firestore::Query::Direction::kDescending, 8, 3);
+    firebase::firestore::DocumentSnapshot snapshot;
+    int64_t expected = 9;
+    while (merged.Next(&snapshot)) {
+      if (snapshot.Get("score").integer_value() != expected) {
+        LogMessage("ERROR: merged query returned score %d, expected %d.",
+                   static_cast<int>(snapshot.Get("score").integer_value()),
+                   static_cast<int>(expected));
+      }
+      expected--;
+    }
+    LogMessage("Merged %d documents, %d duplicates skipped.",
+               static_cast<int>(merged.documents_returned()),
+               static_cast<int>(merged.duplicates()));
+    if (merged.error() != firebase::firestore::kErrorOk ||
+        merged.documents_returned() != 8 || merged.duplicates() != 2) {
+      LogMessage("ERROR: merged query didn't stop at its limit.");
+    }
+    for (const auto& document : documents) writer.Delete(document);
+    writer.Flush();
+  }
+  LogMessage("Tested merged query.");
+
+  LogMessage("Testing document cache.");
+  {
+    firebase::firestore::DocumentReference config =
+        firestore->Collection("cache").Document("config");
+    Await(config.Set(firebase::firestore::MapFieldValue{
+              {"theme", firebase::firestore::FieldValue::String("dark")}}),
+          "config.Set");
+    DocumentCache cache;
+    EventCounter reads;
+    std::string theme;
+    DocumentCache::Callback read =
+        [&reads, &theme](const firebase::firestore::DocumentSnapshot& snapshot,
+                         firebase::firestore::Error error,
+                         const std::string& error_message) {
+          if (error != firebase::firestore::kErrorOk) {
+            LogMessage("ERROR: cached read failed: %d (%s).", error,
+                       error_message.c_str());
+          } else {
+            theme = snapshot.Get("theme").string_value();
+          }
+          reads.Count();
+        };
+    cache.Get(config, read);
+    Await(reads, "cache.Get", 1);
+    cache.Get(config, read);
+    Await(reads, "cache.Get", 2);
+    DocumentCacheStats stats = cache.stats();
+    if (theme != "dark" || stats.hits != 1 || stats.misses != 1) {
+      LogMessage("ERROR: document cache didn't serve the second read.");
+    }
+
+    // A watched document follows its changes.
+    cache.Watch(config);
+    Await(config.Update(firebase::firestore::MapFieldValue{
+              {"theme", firebase::firestore::FieldValue::String("light")}}),
+          "config.Update");
+    firebase::firestore::DocumentSnapshot cached;
+    Clock::time_point deadline =
+        Clock::now() + std::chrono::milliseconds(kTimeoutMs);
+    while (!(cache.Lookup(config.path(), &cached) &&
+             cached.Get("theme").string_value() == "light") &&
+           Clock::now() < deadline) {
+      ProcessEvents(kEventPollMs);
+    }
+    if (!cached.is_valid() || cached.Get("theme").string_value() != "light") {
+      LogMessage("ERROR: document cache didn't follow a watched document.");
+    }
+
+    // Snapshots over the budget are evicted, and stale ones expire.
+    DocumentCacheOptions options;
+    options.max_bytes = 1;
+    DocumentCache tiny(options);
+    tiny.Put(cached);
+    if (tiny.size() != 0 || tiny.stats().evictions != 1) {
+      LogMessage("ERROR: document cache didn't evict over its budget.");
+    }
+    options = DocumentCacheOptions();
+    options.ttl_ms = 1;
+    DocumentCache short_lived(options);
+    short_lived.Put(cached);
+    ProcessEvents(10);
+    if (short_lived.Lookup(config.path(), &cached) ||
+        short_lived.stats().expirations != 1) {
+      LogMessage("ERROR: document cache served an expired snapshot.");
+    }
+    Await(config.Delete(), "config.Delete");
+  }
+  LogMessage("Tested document cache.");
+
   LogMessage("Testing query.");
   firebase::firestore::Query query =
       collection
@@ -0,0 +1,62 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "document_builder.h"  // NOLINT
+
+#include <utility>
+
+int DocumentBuilder::Field(const std::string& name) {
+  for (size_t i = 0; i < slots_.size(); i++) {
+    if (slots_[i].name == name) return static_cast<int>(i);
+  }
+  slots_.emplace_back();
+  slots_.back().name = name;
+  map_.reserve(slots_.size());
+  return static_cast<int>(slots_.size() - 1);
+}
+
+void DocumentBuilder::Reset() {
+  for (Slot& slot : slots_) slot.set = false;
+}
+
+DocumentBuilder& DocumentBuilder::Set(int field,
+                                      firebase::firestore::FieldValue value) {
+  Slot& slot = slots_[field];
+  if (!slot.value) slot.value = &map_[slot.name];
+  *slot.value = std::move(value);
+  slot.set = true;
+  return *this;
+}
+
+const firebase::firestore::MapFieldValue& DocumentBuilder::Build() {
+  for (Slot& slot : slots_) {
+    if (slot.value && !slot.set) {
+      map_.erase(slot.name);
+      slot.value = nullptr;
+    }
+  }
+  return map_;
+}
+
+firebase::firestore::MapFieldValue DocumentBuilder::Take() {
+  Build();
+  firebase::firestore::MapFieldValue map = std::move(map_);
+  map_ = firebase::firestore::MapFieldValue();
+  map_.reserve(slots_.size());
+  for (Slot& slot : slots_) {
+    slot.value = nullptr;
+    slot.set = false;
+  }
+  return map;
+}
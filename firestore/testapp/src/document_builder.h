@@ -0,0 +1,84 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_DOCUMENT_BUILDER_H_  // NOLINT
+#define FIREBASE_TESTAPP_DOCUMENT_BUILDER_H_  // NOLINT
+
+#include <string>
+#include <vector>
+
+#include "firebase/firestore.h"
+
+// Builds the MapFieldValue of a document for code that writes many documents
+// with the same fields. Writing a MapFieldValue literal each time allocates a
+// hash node and a key string per field, plus the bucket array; the builder
+// keeps its map between documents, so a field that was set before is just
+// assigned its new value. Field names are interned once, up front, and
+// referred to by the index Field() returns, so setting a field doesn't hash
+// or copy its name either:
+//
+//   DocumentBuilder builder;
+//   const int kName = builder.Field("name");
+//   const int kCount = builder.Field("count");
+//   for (...) {
+//     builder.Reset();
+//     builder.Set(kName, firebase::firestore::FieldValue::String(name));
+//     builder.Set(kCount, firebase::firestore::FieldValue::Integer(count));
+//     batch.Set(document, builder.Build());
+//   }
+//
+// The values themselves are moved in, so each FieldValue still allocates
+// whatever it needs when it is created. A builder can be moved but not
+// copied.
+class DocumentBuilder {
+ public:
+  DocumentBuilder() = default;
+  DocumentBuilder(DocumentBuilder&&) = default;
+  DocumentBuilder& operator=(DocumentBuilder&&) = default;
+  DocumentBuilder(const DocumentBuilder&) = delete;
+  DocumentBuilder& operator=(const DocumentBuilder&) = delete;
+
+  // Returns the index to set the field called name with, interning the name
+  // the first time it is seen.
+  int Field(const std::string& name);
+  const std::string& field_name(int field) const { return slots_[field].name; }
+
+  // Starts a new document. The fields of the previous one are kept for reuse
+  // until Build() is called.
+  void Reset();
+  DocumentBuilder& Set(int field, firebase::firestore::FieldValue value);
+
+  // Returns the fields set since Reset(), dropping those of the previous
+  // document that weren't set again. The map stays valid until the builder
+  // is next changed.
+  const firebase::firestore::MapFieldValue& Build();
+  // Like Build(), but moves the map out, so the next document starts with
+  // nothing to reuse.
+  firebase::firestore::MapFieldValue Take();
+
+ private:
+  struct Slot {
+    std::string name;
+    // The field's value in map_, if it has one. Elements of an unordered_map
+    // don't move when it rehashes.
+    firebase::firestore::FieldValue* value = nullptr;
+    // Whether the field was set since Reset().
+    bool set = false;
+  };
+
+  std::vector<Slot> slots_;
+  firebase::firestore::MapFieldValue map_;
+};
+
+#endif  // FIREBASE_TESTAPP_DOCUMENT_BUILDER_H_  // NOLINT
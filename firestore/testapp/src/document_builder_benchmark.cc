@@ -0,0 +1,131 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "benchmarks.h"        // NOLINT
+#include "document_builder.h"  // NOLINT
+#include "firebase/firestore.h"
+#include "process_stats.h"     // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Writes added to a batch before it is dropped, uncommitted, to keep the
+// memory used by the benchmark flat.
+const int kWritesPerBatch = 500;
+
+// Calls write(i) iterations times and logs the heap allocations and time
+// each call took.
+template <typename WriteFunction>
+void Measure(const char* label, int iterations, WriteFunction write) {
+  int64_t allocations = GetAllocationCount();
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < iterations; i++) write(i);
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  if (allocations < 0) {
+    LogMessage("  %s: %.0f ns per document.", label,
+               seconds * 1e9 / iterations);
+  } else {
+    LogMessage("  %s: %.1f allocations, %.0f ns per document.", label,
+               static_cast<double>(GetAllocationCount() - allocations) /
+                   iterations,
+               seconds * 1e9 / iterations);
+  }
+}
+
+}  // namespace
+
+bool RunDocumentBuilderBenchmark(firebase::firestore::Firestore* firestore,
+                                 int argc, const char* argv[]) {
+  int iterations = 100000;
+  const char* iterations_arg =
+      GetArgument(argc, argv, "benchmark_iterations");
+  if (iterations_arg) iterations = atoi(iterations_arg);
+  if (iterations <= 0) {
+    LogMessage("ERROR: --benchmark_iterations must be positive.");
+    return false;
+  }
+  if (GetAllocationCount() < 0) {
+    LogMessage("Allocations aren't counted by this build, only reporting "
+               "times.");
+  }
+  LogMessage("Benchmarking %d documents built with a MapFieldValue literal "
+             "and with a DocumentBuilder.",
+             iterations);
+
+  const std::string name = "a document name that doesn't fit inline";
+  firebase::firestore::DocumentReference document =
+      firestore->Collection("benchmarks").Document();
+  size_t fields = 0;
+
+  Measure("Literal, build only", iterations, [&](int i) {
+    firebase::firestore::MapFieldValue data{
+        {"name", firebase::firestore::FieldValue::String(name)},
+        {"index", firebase::firestore::FieldValue::Integer(i)},
+        {"score", firebase::firestore::FieldValue::Double(i * 0.5)},
+        {"even", firebase::firestore::FieldValue::Boolean(i % 2 == 0)},
+        {"parent", firebase::firestore::FieldValue::Null()}};
+    fields += data.size();
+  });
+
+  DocumentBuilder builder;
+  const int kName = builder.Field("name");
+  const int kIndex = builder.Field("index");
+  const int kScore = builder.Field("score");
+  const int kEven = builder.Field("even");
+  const int kParent = builder.Field("parent");
+  auto build = [&](int i) -> const firebase::firestore::MapFieldValue& {
+    builder.Reset();
+    builder.Set(kName, firebase::firestore::FieldValue::String(name))
+        .Set(kIndex, firebase::firestore::FieldValue::Integer(i))
+        .Set(kScore, firebase::firestore::FieldValue::Double(i * 0.5))
+        .Set(kEven, firebase::firestore::FieldValue::Boolean(i % 2 == 0))
+        .Set(kParent, firebase::firestore::FieldValue::Null());
+    return builder.Build();
+  };
+  Measure("Builder, build only", iterations,
+          [&](int i) { fields += build(i).size(); });
+
+  // The same, adding each document to a write batch, to show the difference
+  // relative to the rest of a write. The batches are never committed.
+  firebase::firestore::WriteBatch batch = firestore->batch();
+  Measure("Literal, added to a batch", iterations, [&](int i) {
+    if (i % kWritesPerBatch == 0) batch = firestore->batch();
+    batch.Set(document,
+              firebase::firestore::MapFieldValue{
+                  {"name", firebase::firestore::FieldValue::String(name)},
+                  {"index", firebase::firestore::FieldValue::Integer(i)},
+                  {"score", firebase::firestore::FieldValue::Double(i * 0.5)},
+                  {"even",
+                   firebase::firestore::FieldValue::Boolean(i % 2 == 0)},
+                  {"parent", firebase::firestore::FieldValue::Null()}});
+  });
+  Measure("Builder, added to a batch", iterations, [&](int i) {
+    if (i % kWritesPerBatch == 0) batch = firestore->batch();
+    batch.Set(document, build(i));
+  });
+
+  bool success = fields == static_cast<size_t>(iterations) * 2 * 5;
+  LogMessage(success ? "SUCCESS: Document builder benchmark complete."
+                     : "ERROR: Document builder benchmark failed.");
+  return success;
+}
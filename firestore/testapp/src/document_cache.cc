@@ -0,0 +1,238 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "document_cache.h"  // NOLINT
+
+#include <utility>
+#include <vector>
+
+#include "firebase/future.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+// Rough per-value overhead of a FieldValue and, for map fields, its entry.
+const size_t kValueOverhead = 48;
+
+size_t EstimateSize(const firebase::firestore::FieldValue& value) {
+  size_t size = kValueOverhead;
+  if (value.is_string()) {
+    size += value.string_value().size();
+  } else if (value.type() == firebase::firestore::FieldValue::Type::kBlob) {
+    size += value.blob_size();
+  } else if (value.is_array()) {
+    for (const auto& element : value.array_value()) {
+      size += EstimateSize(element);
+    }
+  } else if (value.is_map()) {
+    for (const auto& field : value.map_value()) {
+      size += field.first.size() + EstimateSize(field.second);
+    }
+  }
+  return size;
+}
+
+size_t EstimateSize(const firebase::firestore::DocumentSnapshot& snapshot) {
+  size_t size = kValueOverhead + snapshot.reference().path().size();
+  for (const auto& field : snapshot.GetData()) {
+    size += field.first.size() + EstimateSize(field.second);
+  }
+  return size;
+}
+
+}  // namespace
+
+DocumentCache::DocumentCache(const DocumentCacheOptions& options)
+    : options_(options) {}
+
+DocumentCache::~DocumentCache() {
+  std::vector<firebase::firestore::ListenerRegistration> registrations;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& watcher : watchers_) {
+    registrations.push_back(watcher.second.registration);
+  }
+  lock.unlock();
+  // Outside the lock, as a listener may be waiting for it.
+  for (auto& registration : registrations) registration.Remove();
+  lock.lock();
+  pending_done_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void DocumentCache::Get(const firebase::firestore::DocumentReference& document,
+                        Callback callback,
+                        firebase::firestore::Source source) {
+  firebase::firestore::DocumentSnapshot snapshot;
+  if (Lookup(document.path(), &snapshot)) {
+    callback(snapshot, firebase::firestore::kErrorOk, std::string());
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.misses++;
+    pending_++;
+  }
+  document.Get(source).OnCompletion(
+      [this, callback](
+          const firebase::Future<firebase::firestore::DocumentSnapshot>&
+              result) {
+        firebase::firestore::Error error =
+            static_cast<firebase::firestore::Error>(result.error());
+        if (error == firebase::firestore::kErrorOk && result.result()) {
+          Entry entry = MakeEntry(*result.result());
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // A live listener's snapshot may be newer than this one, and
+            // doesn't expire, so a stale one would be served until the
+            // document next changes.
+            auto watcher = watchers_.find(entry.path);
+            if (watcher == watchers_.end() || !watcher->second.live) {
+              PutLocked(std::move(entry));
+            }
+          }
+          callback(*result.result(), error, std::string());
+        } else {
+          callback(firebase::firestore::DocumentSnapshot(),
+                   error != firebase::firestore::kErrorOk
+                       ? error
+                       : firebase::firestore::kErrorUnknown,
+                   result.error_message() ? result.error_message() : "");
+        }
+        // Notify with the lock held, so that the destructor can't return and
+        // destroy pending_done_ in between.
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_--;
+        pending_done_.notify_all();
+      });
+}
+
+bool DocumentCache::Lookup(const std::string& path,
+                           firebase::firestore::DocumentSnapshot* snapshot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(path);
+  if (it == index_.end()) return false;
+  auto watcher = watchers_.find(path);
+  bool live = watcher != watchers_.end() && watcher->second.live;
+  if (!live && options_.ttl_ms > 0 &&
+      Clock::now() - it->second->stored >
+          std::chrono::milliseconds(options_.ttl_ms)) {
+    stats_.expirations++;
+    EraseLocked(it);
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *snapshot = it->second->snapshot;
+  stats_.hits++;
+  return true;
+}
+
+void DocumentCache::Put(
+    const firebase::firestore::DocumentSnapshot& snapshot) {
+  Entry entry = MakeEntry(snapshot);
+  std::lock_guard<std::mutex> lock(mutex_);
+  PutLocked(std::move(entry));
+}
+
+DocumentCache::Entry DocumentCache::MakeEntry(
+    const firebase::firestore::DocumentSnapshot& snapshot) {
+  Entry entry;
+  entry.path = snapshot.reference().path();
+  entry.snapshot = snapshot;
+  entry.stored = Clock::now();
+  entry.bytes = EstimateSize(snapshot);
+  return entry;
+}
+
+void DocumentCache::PutLocked(Entry entry) {
+  auto it = index_.find(entry.path);
+  if (it != index_.end()) EraseLocked(it);
+  bytes_ += entry.bytes;
+  entries_.push_front(std::move(entry));
+  index_[entries_.front().path] = entries_.begin();
+  while (bytes_ > options_.max_bytes && !entries_.empty()) {
+    stats_.evictions++;
+    EraseLocked(index_.find(entries_.back().path));
+  }
+}
+
+void DocumentCache::Invalidate(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(path);
+  if (it != index_.end()) EraseLocked(it);
+}
+
+void DocumentCache::EraseLocked(
+    std::unordered_map<std::string, std::list<Entry>::iterator>::iterator it) {
+  bytes_ -= it->second->bytes;
+  entries_.erase(it->second);
+  index_.erase(it);
+}
+
+void DocumentCache::Watch(
+    const firebase::firestore::DocumentReference& document) {
+  std::string path = document.path();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (watchers_.count(path)) return;
+    watchers_[path];
+  }
+  firebase::firestore::DocumentReference reference = document;
+  firebase::firestore::ListenerRegistration registration =
+      reference.AddSnapshotListener(
+          [this, path](const firebase::firestore::DocumentSnapshot& snapshot,
+                       firebase::firestore::Error error,
+                       const std::string& error_message) {
+            Entry entry;
+            if (error == firebase::firestore::kErrorOk) {
+              entry = MakeEntry(snapshot);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            Watcher& watcher = watchers_[path];
+            if (error != firebase::firestore::kErrorOk) {
+              LogMessage("ERROR: Cache listener for %s failed: %d (%s).",
+                         path.c_str(), error, error_message.c_str());
+              watcher.live = false;
+              auto it = index_.find(path);
+              if (it != index_.end()) EraseLocked(it);
+              return;
+            }
+            watcher.live = true;
+            PutLocked(std::move(entry));
+          });
+  std::lock_guard<std::mutex> lock(mutex_);
+  watchers_[path].registration = registration;
+}
+
+void DocumentCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  bytes_ = 0;
+}
+
+size_t DocumentCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t DocumentCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+DocumentCacheStats DocumentCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
@@ -0,0 +1,136 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_DOCUMENT_CACHE_H_  // NOLINT
+#define FIREBASE_TESTAPP_DOCUMENT_CACHE_H_  // NOLINT
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "firebase/firestore.h"
+
+struct DocumentCacheOptions {
+  // Estimated size of the cached snapshots above which the least recently
+  // used ones are evicted.
+  size_t max_bytes = 4 * 1024 * 1024;
+  // How long a snapshot read with Get() is served from the cache, or 0 to
+  // serve it until it is evicted. Watched documents don't expire.
+  int ttl_ms = 60 * 1000;
+};
+
+struct DocumentCacheStats {
+  // Get() and Lookup() calls answered from the cache.
+  size_t hits = 0;
+  // Get() calls that read the document from Firestore.
+  size_t misses = 0;
+  // Cached snapshots found to be older than the TTL.
+  size_t expirations = 0;
+  // Cached snapshots dropped to stay within the memory budget.
+  size_t evictions = 0;
+};
+
+// An in-process cache of document snapshots, keyed by document path, for
+// documents that are read over and over, such as configuration and profiles.
+// Even with persistence enabled, each DocumentReference::Get() goes through
+// Firestore's local store, and with the default source to the server.
+//
+// Snapshots are added by the cache's own Get(), and kept current by a
+// snapshot listener for documents passed to Watch(). They are evicted in
+// least recently used order once their estimated size passes the memory
+// budget. The cache can be used from any thread.
+class DocumentCache {
+ public:
+  using Callback = std::function<void(
+      const firebase::firestore::DocumentSnapshot& snapshot,
+      firebase::firestore::Error error, const std::string& error_message)>;
+
+  explicit DocumentCache(
+      const DocumentCacheOptions& options = DocumentCacheOptions());
+  // Removes the listeners and waits for any Get() still in progress.
+  ~DocumentCache();
+
+  DocumentCache(const DocumentCache&) = delete;
+  DocumentCache& operator=(const DocumentCache&) = delete;
+
+  // Calls callback with a snapshot of document. A fresh snapshot from the
+  // cache is passed straight away, on the calling thread; otherwise the
+  // document is read with DocumentReference::Get(source), the snapshot is
+  // cached unless a live listener from Watch() keeps the document current,
+  // and callback is called when the read completes.
+  void Get(const firebase::firestore::DocumentReference& document,
+           Callback callback,
+           firebase::firestore::Source source =
+               firebase::firestore::Source::kDefault);
+
+  // Stores a fresh cached snapshot of the document at path in snapshot and
+  // returns true, or returns false if there isn't one.
+  bool Lookup(const std::string& path,
+              firebase::firestore::DocumentSnapshot* snapshot);
+
+  // Adds or replaces the snapshot of a document.
+  void Put(const firebase::firestore::DocumentSnapshot& snapshot);
+  void Invalidate(const std::string& path);
+
+  // Keeps the cached snapshot of document current with a snapshot listener,
+  // until the cache is destroyed.
+  void Watch(const firebase::firestore::DocumentReference& document);
+
+  void Clear();
+  size_t size() const;
+  // Estimated size of the cached snapshots.
+  size_t bytes() const;
+  DocumentCacheStats stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::string path;
+    firebase::firestore::DocumentSnapshot snapshot;
+    Clock::time_point stored;
+    size_t bytes = 0;
+  };
+
+  struct Watcher {
+    firebase::firestore::ListenerRegistration registration;
+    // Whether the listener is delivering snapshots, so that the cached one is
+    // current whatever its age.
+    bool live = false;
+  };
+
+  static Entry MakeEntry(const firebase::firestore::DocumentSnapshot& snapshot);
+  void PutLocked(Entry entry);
+  void EraseLocked(std::unordered_map<std::string,
+                                      std::list<Entry>::iterator>::iterator it);
+
+  DocumentCacheOptions options_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  std::unordered_map<std::string, Watcher> watchers_;
+  size_t bytes_ = 0;
+  DocumentCacheStats stats_;
+  // Get() calls still waiting for Firestore, which the destructor waits for.
+  int pending_ = 0;
+  std::condition_variable pending_done_;
+};
+
+#endif  // FIREBASE_TESTAPP_DOCUMENT_CACHE_H_  // NOLINT
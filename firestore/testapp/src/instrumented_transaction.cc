@@ -0,0 +1,149 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "instrumented_transaction.h"  // NOLINT
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "firebase/future.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollMs = 1;
+
+double SecondsBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// Whether a run that failed with error may succeed if it is run again.
+bool IsRetryable(firebase::firestore::Error error) {
+  switch (error) {
+    case firebase::firestore::kErrorAborted:
+    case firebase::firestore::kErrorDeadlineExceeded:
+    case firebase::firestore::kErrorResourceExhausted:
+    case firebase::firestore::kErrorUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+int BackoffDelayMs(const TransactionBackoff& backoff, int completed_runs) {
+  double delay = backoff.initial_delay_ms;
+  for (int i = 1; i < completed_runs && delay < backoff.max_delay_ms; i++) {
+    delay *= backoff.multiplier;
+  }
+  delay = std::min(delay, static_cast<double>(backoff.max_delay_ms));
+  if (backoff.jitter) {
+    static std::mutex random_mutex;
+    static std::minstd_rand random(static_cast<std::minstd_rand::result_type>(
+        Clock::now().time_since_epoch().count()));
+    std::lock_guard<std::mutex> lock(random_mutex);
+    delay *= std::uniform_real_distribution<double>(0.5, 1.0)(random);
+  }
+  return static_cast<int>(delay);
+}
+
+}  // namespace
+
+firebase::firestore::Error RunInstrumentedTransaction(
+    firebase::firestore::Firestore* firestore,
+    const TransactionFunction& update,
+    const TransactionBackoff& backoff,
+    TransactionStats* stats,
+    std::string* error_message) {
+  *stats = TransactionStats();
+  // The update function runs on a Firestore thread.
+  std::mutex mutex;
+  firebase::firestore::Error last_result = firebase::firestore::kErrorOk;
+  firebase::firestore::Error error = firebase::firestore::kErrorOk;
+  for (;;) {
+    stats->runs++;
+    Clock::time_point run_start = Clock::now();
+    double run_function_seconds = 0;
+    firebase::Future<void> future = firestore->RunTransaction(
+        [&](firebase::firestore::Transaction& transaction,
+            std::string& message) {
+          Clock::time_point start = Clock::now();
+          firebase::firestore::Error result = update(transaction, message);
+          double seconds = SecondsBetween(start, Clock::now());
+          std::lock_guard<std::mutex> lock(mutex);
+          stats->attempts++;
+          run_function_seconds += seconds;
+          last_result = result;
+          return result;
+        });
+    while (future.status() == firebase::kFutureStatusPending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+
+    // The future may complete before the Firestore thread releases the mutex.
+    firebase::firestore::Error function_result;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      function_result = last_result;
+      stats->function_seconds += run_function_seconds;
+      stats->wait_seconds +=
+          SecondsBetween(run_start, Clock::now()) - run_function_seconds;
+    }
+    if (future.status() == firebase::kFutureStatusComplete) {
+      error = static_cast<firebase::firestore::Error>(future.error());
+      if (error_message) *error_message = future.error_message();
+    } else {
+      error = firebase::firestore::kErrorUnknown;
+      if (error_message) *error_message = "Transaction was abandoned";
+    }
+    if (error == firebase::firestore::kErrorOk) {
+      stats->committed = true;
+      break;
+    }
+    if (function_result != firebase::firestore::kErrorOk &&
+        !IsRetryable(function_result)) {
+      // The update function failed the transaction itself. Retryable errors,
+      // e.g. from a Transaction::Get() that failed, are retried below like
+      // any other.
+      stats->user_aborts++;
+      break;
+    }
+    stats->failures[error]++;
+    if (!IsRetryable(error) || stats->runs >= backoff.max_runs) break;
+
+    int delay_ms = BackoffDelayMs(backoff, stats->runs);
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    stats->backoff_seconds += delay_ms / 1000.0;
+  }
+  return error;
+}
+
+void LogTransactionStats(const char* name, const TransactionStats& stats) {
+  LogMessage(
+      "  %s: %d runs, %d attempts (%d wasted), %d user aborts, %.1f ms in the "
+      "update function, %.1f ms waiting, %.1f ms backing off.",
+      name, stats.runs, stats.attempts, stats.wasted_attempts(),
+      stats.user_aborts, stats.function_seconds * 1000.0,
+      stats.wait_seconds * 1000.0, stats.backoff_seconds * 1000.0);
+  for (const auto& failure : stats.failures) {
+    LogMessage("    %d runs failed with error %d.", failure.second,
+               failure.first);
+  }
+}
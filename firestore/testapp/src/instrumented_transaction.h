@@ -0,0 +1,83 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_INSTRUMENTED_TRANSACTION_H_  // NOLINT
+#define FIREBASE_TESTAPP_INSTRUMENTED_TRANSACTION_H_  // NOLINT
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include "firebase/firestore.h"
+
+// How RunInstrumentedTransaction() retries a transaction that Firestore gave
+// up on. Firestore already retries a transaction a few times when the
+// documents it read change before it commits; these retries add a growing,
+// jittered delay between whole transactions so that contending clients
+// spread out instead of colliding again straight away.
+struct TransactionBackoff {
+  // Number of times RunTransaction() is called before giving up. 1 disables
+  // retries.
+  int max_runs = 3;
+  // Delay before the second run, multiplied by multiplier for each further
+  // run up to max_delay_ms.
+  int initial_delay_ms = 100;
+  double multiplier = 2.0;
+  int max_delay_ms = 5000;
+  // Whether to pick each delay at random between half and all of it.
+  bool jitter = true;
+};
+
+// Where the time and work of a transaction went.
+struct TransactionStats {
+  // Calls to RunTransaction().
+  int runs = 0;
+  // Calls to the update function, over all runs. Every attempt after the
+  // first of each run is work thrown away because of contention.
+  int attempts = 0;
+  // Runs that the update function failed by returning an error that isn't
+  // retryable. Retryable ones, e.g. passed on from a failed
+  // Transaction::Get(), count as failures and are retried.
+  int user_aborts = 0;
+  // Other runs that failed, by error.
+  std::map<firebase::firestore::Error, int> failures;
+  // Time spent in the update function, waiting for Firestore and backing off
+  // between runs.
+  double function_seconds = 0;
+  double wait_seconds = 0;
+  double backoff_seconds = 0;
+  bool committed = false;
+
+  int wasted_attempts() const { return attempts - runs; }
+};
+
+using TransactionFunction = std::function<firebase::firestore::Error(
+    firebase::firestore::Transaction&, std::string&)>;
+
+// Runs update as a transaction and waits for it to complete, recording what
+// happened in stats. If Firestore gives up on the transaction because of
+// contention or a lost connection, it is run again according to backoff.
+// Returns the error of the last run and stores its message in error_message,
+// if given. May be called from any thread.
+firebase::firestore::Error RunInstrumentedTransaction(
+    firebase::firestore::Firestore* firestore,
+    const TransactionFunction& update,
+    const TransactionBackoff& backoff,
+    TransactionStats* stats,
+    std::string* error_message);
+
+// Logs stats, prefixed by name.
+void LogTransactionStats(const char* name, const TransactionStats& stats);
+
+#endif  // FIREBASE_TESTAPP_INSTRUMENTED_TRANSACTION_H_  // NOLINT
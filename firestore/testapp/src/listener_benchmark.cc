@@ -0,0 +1,344 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"     // NOLINT
+#include "bulk_writer.h"    // NOLINT
+#include "firebase/firestore.h"
+#include "firebase/future.h"
+#include "process_stats.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollMs = 10;
+// Number of distinct values of the "group" field, and so of distinct queries.
+const int kGroups = 10;
+// How long to wait for the listeners to see every write.
+const int kTimeoutSeconds = 60;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+firebase::firestore::MapFieldValue Payload(int group, int64_t sequence) {
+  return firebase::firestore::MapFieldValue{
+      {"group", firebase::firestore::FieldValue::Integer(group)},
+      {"sequence", firebase::firestore::FieldValue::Integer(sequence)},
+      {"sent_us", firebase::firestore::FieldValue::Integer(NowMicros())}};
+}
+
+// What one registration has seen. Firestore calls the listeners on its own
+// threads while the main thread reads the counts, so they are atomic, and the
+// lags are guarded by a mutex.
+struct ListenerState {
+  // Records a document delivered by a snapshot, other than the first.
+  void Record(const firebase::firestore::DocumentSnapshot& document,
+              int64_t now_us) {
+    int64_t sequence = document.Get("sequence").integer_value();
+    if (sequence < 0) return;
+    int64_t seen = max_sequence.load();
+    while (sequence > seen &&
+           !max_sequence.compare_exchange_weak(seen, sequence)) {
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    lags.push_back((now_us - document.Get("sent_us").integer_value()) / 1e6);
+  }
+
+  // Records a snapshot, and returns whether it is the first.
+  bool Deliver(firebase::firestore::Error error) {
+    if (error != firebase::firestore::kErrorOk) {
+      errors++;
+      return false;
+    }
+    // Each registration's callbacks are serialized, so only the main thread
+    // races with this, and it doesn't read first_snapshot_seconds until
+    // snapshots is non-zero.
+    bool first = snapshots == 0;
+    if (first) first_snapshot_seconds = SecondsSince(registered);
+    snapshots++;
+    return first;
+  }
+
+  Clock::time_point registered;
+  // The highest sequence number this listener must see once every write
+  // has been delivered.
+  int64_t expected_sequence = -1;
+  std::atomic<int> snapshots{0};
+  std::atomic<int> errors{0};
+  std::atomic<int64_t> max_sequence{-1};
+  // Time from registration to the first snapshot.
+  std::atomic<double> first_snapshot_seconds{0};
+  std::mutex mutex;
+  std::vector<double> lags;
+};
+
+}  // namespace
+
+bool RunListenerBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                          const char* argv[]) {
+  int num_listeners = 500;
+  int num_documents = 50;
+  int num_writes = 2000;
+  int writes_per_second = 500;
+  const char* listeners_arg = GetArgument(argc, argv, "benchmark_listeners");
+  if (listeners_arg) num_listeners = atoi(listeners_arg);
+  const char* documents_arg = GetArgument(argc, argv, "benchmark_documents");
+  if (documents_arg) num_documents = atoi(documents_arg);
+  const char* writes_arg = GetArgument(argc, argv, "benchmark_writes");
+  if (writes_arg) num_writes = atoi(writes_arg);
+  const char* rate_arg =
+      GetArgument(argc, argv, "benchmark_writes_per_second");
+  if (rate_arg) writes_per_second = atoi(rate_arg);
+  if (num_listeners <= 0 || num_documents <= 0 || num_writes <= 0 ||
+      writes_per_second <= 0) {
+    LogMessage("ERROR: --benchmark_listeners, --benchmark_documents, "
+               "--benchmark_writes and --benchmark_writes_per_second must be "
+               "positive.");
+    return false;
+  }
+  LogMessage("Benchmarking %d snapshot listeners over %d documents with %d "
+             "writes at %d writes/s.",
+             num_listeners, num_documents, num_writes, writes_per_second);
+
+  // The writes go through a second instance, so that the listeners learn of
+  // them from the server, as they would of another client's. Written through
+  // the listeners' own instance, each write would be delivered locally
+  // before it was even sent.
+  firebase::App* writer_app;
+#if defined(__ANDROID__)
+  writer_app = firebase::App::Create(firestore->app()->options(),
+                                     "listener_benchmark_writer", GetJniEnv(),
+                                     GetActivity());
+#else
+  writer_app = firebase::App::Create(firestore->app()->options(),
+                                     "listener_benchmark_writer");
+#endif  // defined(__ANDROID__)
+  firebase::firestore::Firestore* writer_firestore =
+      firebase::firestore::Firestore::GetInstance(writer_app);
+  if (!writer_firestore) {
+    LogMessage("ERROR: Unable to create the writer's Firestore instance.");
+    delete writer_app;
+    return false;
+  }
+  firebase::firestore::Settings settings = writer_firestore->settings();
+  settings.set_host(firestore->settings().host());
+  settings.set_ssl_enabled(firestore->settings().is_ssl_enabled());
+  settings.set_persistence_enabled(false);
+  writer_firestore->set_settings(settings);
+
+  firebase::firestore::CollectionReference collection =
+      firestore->Collection("benchmarks").Document().Collection("listeners");
+  std::vector<firebase::firestore::DocumentReference> documents;
+  bool success;
+  {
+    BulkWriter writer(firestore);
+    for (int i = 0; i < num_documents; i++) {
+      documents.push_back(collection.Document());
+      writer.Set(documents.back(), Payload(i % kGroups, -1));
+    }
+    success = writer.Flush();
+  }
+  if (!success) {
+    LogMessage("ERROR: Unable to write the benchmark data.");
+    delete writer_firestore;
+    delete writer_app;
+    return false;
+  }
+  std::vector<firebase::firestore::DocumentReference> writer_documents;
+  for (const auto& document : documents) {
+    writer_documents.push_back(writer_firestore->Document(document.path()));
+  }
+
+  // The last sequence number written to each document, and so the highest
+  // each listener has to see.
+  std::vector<int64_t> last_sequence(num_documents, -1);
+  for (int i = std::max(0, num_writes - num_documents); i < num_writes; i++) {
+    last_sequence[i % num_documents] = i;
+  }
+
+  // Even listeners watch a single document, odd ones the query for a group,
+  // which matches about one document in kGroups.
+  int64_t memory_baseline = GetResidentMemoryBytes();
+  std::vector<std::unique_ptr<ListenerState>> states;
+  std::vector<firebase::firestore::ListenerRegistration> registrations;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < num_listeners; i++) {
+    states.emplace_back(new ListenerState);
+    ListenerState* state = states.back().get();
+    state->registered = Clock::now();
+    int target = (i / 2) % num_documents;
+    if (i % 2 == 0) {
+      state->expected_sequence = last_sequence[target];
+      registrations.push_back(documents[target].AddSnapshotListener(
+          [state](const firebase::firestore::DocumentSnapshot& document,
+                  firebase::firestore::Error error, const std::string&) {
+            int64_t now_us = NowMicros();
+            if (state->Deliver(error) ||
+                error != firebase::firestore::kErrorOk) {
+              return;
+            }
+            state->Record(document, now_us);
+          }));
+    } else {
+      int group = target % kGroups;
+      for (int d = group; d < num_documents; d += kGroups) {
+        state->expected_sequence =
+            std::max(state->expected_sequence, last_sequence[d]);
+      }
+      registrations.push_back(
+          collection
+              .WhereEqualTo("group",
+                            firebase::firestore::FieldValue::Integer(group))
+              .AddSnapshotListener(
+                  [state](const firebase::firestore::QuerySnapshot& snapshot,
+                          firebase::firestore::Error error,
+                          const std::string&) {
+                    int64_t now_us = NowMicros();
+                    if (state->Deliver(error) ||
+                        error != firebase::firestore::kErrorOk) {
+                      return;
+                    }
+                    for (const auto& change : snapshot.DocumentChanges()) {
+                      if (change.type() !=
+                          firebase::firestore::DocumentChange::Type::kRemoved) {
+                        state->Record(change.document(), now_us);
+                      }
+                    }
+                  }));
+    }
+  }
+  double register_seconds = SecondsSince(start);
+
+  int ready = 0;
+  while (SecondsSince(start) < kTimeoutSeconds) {
+    ready = 0;
+    for (const auto& state : states) {
+      if (state->snapshots > 0 || state->errors > 0) ready++;
+    }
+    if (ready == num_listeners || ProcessEvents(kPollMs)) break;
+  }
+  int64_t memory = GetResidentMemoryBytes();
+  std::vector<double> first_snapshots;
+  for (const auto& state : states) {
+    if (state->snapshots > 0) {
+      first_snapshots.push_back(state->first_snapshot_seconds);
+    }
+  }
+  LogMessage("  %d listeners registered in %.2f s, %d with a first snapshot "
+             "after %.2f s.",
+             num_listeners, register_seconds,
+             static_cast<int>(first_snapshots.size()), SecondsSince(start));
+  LogLatencies("Registration to first snapshot", first_snapshots);
+  if (memory >= 0 && memory_baseline >= 0) {
+    LogMessage("  Memory: %.1f KB per registration.",
+               (memory - memory_baseline) / 1024.0 / num_listeners);
+  }
+
+  // Write from another thread at a steady rate, as a busy app would, while
+  // the listeners are called back.
+  int initial_snapshots = 0;
+  for (const auto& state : states) initial_snapshots += state->snapshots;
+  std::atomic<int> failed_writes{0};
+  start = Clock::now();
+  std::thread writer([&]() {
+    std::vector<firebase::Future<void>> writes;
+    for (int i = 0; i < num_writes; i++) {
+      std::this_thread::sleep_until(
+          start + std::chrono::microseconds(static_cast<int64_t>(i) *
+                                            1000000 / writes_per_second));
+      writes.push_back(writer_documents[i % num_documents].Set(
+          Payload(i % num_documents % kGroups, i)));
+    }
+    for (const auto& write : writes) {
+      while (write.status() == firebase::kFutureStatusPending) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      if (write.error() != firebase::firestore::kErrorOk) failed_writes++;
+    }
+  });
+  int caught_up = 0;
+  while (SecondsSince(start) < kTimeoutSeconds) {
+    caught_up = 0;
+    for (const auto& state : states) {
+      if (state->max_sequence >= state->expected_sequence) caught_up++;
+    }
+    if (caught_up == num_listeners || ProcessEvents(kPollMs)) break;
+  }
+  double delivery_seconds = SecondsSince(start);
+  writer.join();
+  double write_seconds = SecondsSince(start);
+
+  int delivered = -initial_snapshots;
+  int errors = 0;
+  std::vector<double> lags;
+  std::vector<double> mean_lags;
+  for (const auto& state : states) {
+    delivered += state->snapshots;
+    errors += state->errors;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->lags.empty()) continue;
+    double total = 0;
+    for (double lag : state->lags) total += lag;
+    mean_lags.push_back(total / state->lags.size());
+    lags.insert(lags.end(), state->lags.begin(), state->lags.end());
+  }
+  LogMessage("  %d writes in %.2f s, %d failed.", num_writes, write_seconds,
+             static_cast<int>(failed_writes));
+  LogMessage("  %d snapshots delivered in %.2f s, %.0f snapshots/s, %d "
+             "listeners caught up, %d listener errors.",
+             delivered, delivery_seconds,
+             delivery_seconds > 0 ? delivered / delivery_seconds : 0,
+             caught_up, errors);
+  LogLatencies("Write to delivery", lags);
+  LogLatencies("Mean per listener", mean_lags);
+  success = caught_up == num_listeners && errors == 0 && failed_writes == 0;
+
+  for (auto& registration : registrations) registration.Remove();
+  {
+    BulkWriter writer(firestore);
+    for (const auto& document : documents) writer.Delete(document);
+    success = writer.Flush() && success;
+  }
+  writer_documents.clear();
+  firebase::Future<void> terminated = writer_firestore->Terminate();
+  while (terminated.status() == firebase::kFutureStatusPending) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  delete writer_firestore;
+  delete writer_app;
+  LogMessage(success ? "SUCCESS: Listener benchmark complete."
+                     : "ERROR: Listener benchmark failed.");
+  return success;
+}
@@ -0,0 +1,250 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "merged_query.h"  // NOLINT
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace {
+
+// The position of each type in Firestore's ordering.
+int TypeOrder(const firebase::firestore::FieldValue& value) {
+  using Type = firebase::firestore::FieldValue::Type;
+  switch (value.type()) {
+    case Type::kNull:
+      return 0;
+    case Type::kBoolean:
+      return 1;
+    case Type::kInteger:
+    case Type::kDouble:
+      return 2;
+    case Type::kTimestamp:
+      return 3;
+    case Type::kString:
+      return 4;
+    case Type::kBlob:
+      return 5;
+    case Type::kReference:
+      return 6;
+    case Type::kGeoPoint:
+      return 7;
+    case Type::kArray:
+      return 8;
+    case Type::kMap:
+      return 9;
+    default:
+      return 10;
+  }
+}
+
+template <typename T>
+int Compare(const T& a, const T& b) {
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+int CompareNumbers(const firebase::firestore::FieldValue& a,
+                   const firebase::firestore::FieldValue& b) {
+  if (a.is_integer() && b.is_integer()) {
+    return Compare(a.integer_value(), b.integer_value());
+  }
+  double x = a.is_integer() ? static_cast<double>(a.integer_value())
+                            : a.double_value();
+  double y = b.is_integer() ? static_cast<double>(b.integer_value())
+                            : b.double_value();
+  // NaN sorts before every other number.
+  if (std::isnan(x) || std::isnan(y)) {
+    return Compare(!std::isnan(x), !std::isnan(y));
+  }
+  return Compare(x, y);
+}
+
+// Splits a document path into its segments, which Firestore compares one at
+// a time, so "a/b" sorts before "a-c" although '-' sorts before '/'.
+std::vector<std::string> PathSegments(const std::string& path) {
+  std::vector<std::string> segments;
+  size_t start = 0;
+  for (;;) {
+    size_t end = path.find('/', start);
+    segments.push_back(path.substr(start, end - start));
+    if (end == std::string::npos) return segments;
+    start = end + 1;
+  }
+}
+
+}  // namespace
+
+int CompareFieldValues(const firebase::firestore::FieldValue& a,
+                       const firebase::firestore::FieldValue& b) {
+  int order = Compare(TypeOrder(a), TypeOrder(b));
+  if (order != 0) return order;
+  using Type = firebase::firestore::FieldValue::Type;
+  switch (a.type()) {
+    case Type::kNull:
+      return 0;
+    case Type::kBoolean:
+      return Compare(a.boolean_value(), b.boolean_value());
+    case Type::kInteger:
+    case Type::kDouble:
+      return CompareNumbers(a, b);
+    case Type::kTimestamp:
+      order = Compare(a.timestamp_value().seconds(),
+                      b.timestamp_value().seconds());
+      return order != 0 ? order
+                         : Compare(a.timestamp_value().nanoseconds(),
+                                   b.timestamp_value().nanoseconds());
+    case Type::kString:
+      return Compare(a.string_value(), b.string_value());
+    case Type::kBlob: {
+      int bytes = memcmp(a.blob_value(), b.blob_value(),
+                         std::min(a.blob_size(), b.blob_size()));
+      return bytes != 0 ? Compare(bytes, 0)
+                        : Compare(a.blob_size(), b.blob_size());
+    }
+    case Type::kReference: {
+      std::vector<std::string> x = PathSegments(a.reference_value().path());
+      std::vector<std::string> y = PathSegments(b.reference_value().path());
+      return Compare(x, y);
+    }
+    case Type::kGeoPoint: {
+      firebase::firestore::GeoPoint x = a.geo_point_value();
+      firebase::firestore::GeoPoint y = b.geo_point_value();
+      order = Compare(x.latitude(), y.latitude());
+      return order != 0 ? order : Compare(x.longitude(), y.longitude());
+    }
+    case Type::kArray: {
+      std::vector<firebase::firestore::FieldValue> x = a.array_value();
+      std::vector<firebase::firestore::FieldValue> y = b.array_value();
+      for (size_t i = 0; i < x.size() && i < y.size(); i++) {
+        order = CompareFieldValues(x[i], y[i]);
+        if (order != 0) return order;
+      }
+      return Compare(x.size(), y.size());
+    }
+    case Type::kMap: {
+      // Maps are compared entry by entry in key order, a key before its
+      // value.
+      firebase::firestore::MapFieldValue a_map = a.map_value();
+      firebase::firestore::MapFieldValue b_map = b.map_value();
+      std::map<std::string, firebase::firestore::FieldValue> x(a_map.begin(),
+                                                               a_map.end());
+      std::map<std::string, firebase::firestore::FieldValue> y(b_map.begin(),
+                                                               b_map.end());
+      auto i = x.begin();
+      auto j = y.begin();
+      for (; i != x.end() && j != y.end(); ++i, ++j) {
+        order = Compare(i->first, j->first);
+        if (order == 0) order = CompareFieldValues(i->second, j->second);
+        if (order != 0) return order;
+      }
+      return Compare(x.size(), y.size());
+    }
+    default:
+      // Sentinels such as FieldValue::Delete() are never stored, so a query
+      // can't return them.
+      return 0;
+  }
+}
+
+MergedQuery::MergedQuery(const std::vector<firebase::firestore::Query>& queries,
+                         const std::string& order_field,
+                         firebase::firestore::Query::Direction direction,
+                         int limit, int page_size)
+    : order_field_(order_field),
+      descending_(direction ==
+                  firebase::firestore::Query::Direction::kDescending),
+      limit_(limit > 0 ? static_cast<size_t>(limit) : 0),
+      started_(false),
+      refill_(kNoSource),
+      duplicates_(0),
+      error_(firebase::firestore::kErrorOk) {
+  // Every document read from a query is either returned or a duplicate of
+  // one that was, so no query can contribute more than limit documents, and
+  // its iterator stops fetching once it has that many.
+  for (const auto& query : queries) {
+    iterators_.emplace_back(new QueryIterator(
+        query.OrderBy(order_field, direction), page_size, limit));
+  }
+}
+
+size_t MergedQuery::documents_fetched() const {
+  size_t documents = 0;
+  for (const auto& iterator : iterators_) {
+    documents += iterator->documents_fetched();
+  }
+  return documents;
+}
+
+bool MergedQuery::After(const Head& a, const Head& b) const {
+  int order = CompareFieldValues(a.value, b.value);
+  if (order == 0) order = Compare(a.path, b.path);
+  return descending_ ? order < 0 : order > 0;
+}
+
+bool MergedQuery::Advance(size_t source) {
+  Head head;
+  if (!iterators_[source]->Next(&head.document)) {
+    if (iterators_[source]->error() == firebase::firestore::kErrorOk) {
+      return true;
+    }
+    error_ = iterators_[source]->error();
+    error_message_ = iterators_[source]->error_message();
+    return false;
+  }
+  head.value = head.document.Get(order_field_);
+  head.path = head.document.reference().path();
+  head.source = source;
+  heap_.push_back(std::move(head));
+  std::push_heap(heap_.begin(), heap_.end(),
+                 [this](const Head& a, const Head& b) { return After(a, b); });
+  return true;
+}
+
+bool MergedQuery::Next(firebase::firestore::DocumentSnapshot* document) {
+  if (error_ != firebase::firestore::kErrorOk) return false;
+  if (!started_) {
+    // Every query's first page was requested when its iterator was created,
+    // so these wait for the slowest of them rather than for each in turn.
+    started_ = true;
+    for (size_t i = 0; i < iterators_.size(); i++) {
+      if (!Advance(i)) return false;
+    }
+  }
+  while (!limit_ || returned_.size() < limit_) {
+    // Only now read the next document of the query the last one came from,
+    // so that reaching the limit never waits for another page.
+    if (refill_ != kNoSource) {
+      size_t source = refill_;
+      refill_ = kNoSource;
+      if (!Advance(source)) return false;
+    }
+    if (heap_.empty()) break;
+    std::pop_heap(heap_.begin(), heap_.end(),
+                  [this](const Head& a, const Head& b) { return After(a, b); });
+    Head head = std::move(heap_.back());
+    heap_.pop_back();
+    refill_ = head.source;
+    if (!returned_.insert(head.path).second) {
+      duplicates_++;
+      continue;
+    }
+    *document = std::move(head.document);
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,108 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_MERGED_QUERY_H_  // NOLINT
+#define FIREBASE_TESTAPP_MERGED_QUERY_H_  // NOLINT
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "firebase/firestore.h"
+#include "query_iterator.h"  // NOLINT
+
+// Compares two field values in the order Firestore sorts them: by type (null,
+// booleans, numbers, timestamps, strings, blobs, references, geo points,
+// arrays, maps), then by value, with integers and doubles compared as
+// numbers, references by path segment and maps entry by entry in key order.
+// Returns a negative number, zero or a positive number as a is less than,
+// equal to or greater than b.
+int CompareFieldValues(const firebase::firestore::FieldValue& a,
+                       const firebase::firestore::FieldValue& b);
+
+// Runs the queries of a disjunction (an OR, or an IN split into equalities)
+// and returns their documents as a single result, sorted on one field.
+//
+// Every query is ordered on order_field and read with its own QueryIterator,
+// so they all run concurrently, a page at a time. Their results are k-way
+// merged as they arrive, with documents matched by more than one query
+// returned once, and reading stops as soon as limit documents have been
+// returned, so a limited result never fetches much more than it needs:
+//
+//   MergedQuery merged({posts.WhereEqualTo("author", alice),
+//                       posts.WhereEqualTo("author", bob)},
+//                      "published", Query::Direction::kDescending, 20);
+//   firebase::firestore::DocumentSnapshot post;
+//   while (merged.Next(&post)) Show(post);
+//
+// The queries must not have an order, limit or cursor of their own, and may
+// only have inequality filters on order_field. Documents with equal values
+// of order_field are returned in document path order.
+class MergedQuery {
+ public:
+  // A limit of 0 returns every document.
+  MergedQuery(const std::vector<firebase::firestore::Query>& queries,
+              const std::string& order_field,
+              firebase::firestore::Query::Direction direction =
+                  firebase::firestore::Query::Direction::kAscending,
+              int limit = 0, int page_size = 100);
+
+  // Stores the next document in document, waiting for the queries as
+  // needed. Returns false once every document, or limit documents, have been
+  // returned, or if a query failed, in which case error() describes the
+  // failure.
+  bool Next(firebase::firestore::DocumentSnapshot* document);
+
+  firebase::firestore::Error error() const { return error_; }
+  const std::string& error_message() const { return error_message_; }
+  size_t documents_returned() const { return returned_.size(); }
+  // Documents skipped because another query had already returned them.
+  size_t duplicates() const { return duplicates_; }
+  // Documents fetched by all the queries, including those that were never
+  // returned.
+  size_t documents_fetched() const;
+
+ private:
+  // The next document of one of the queries.
+  struct Head {
+    firebase::firestore::DocumentSnapshot document;
+    firebase::firestore::FieldValue value;
+    std::string path;
+    size_t source;
+  };
+
+  // Reads the next document of source into the heap. Returns false if the
+  // query failed.
+  bool Advance(size_t source);
+  // Returns whether a comes after b, and so belongs lower in the heap.
+  bool After(const Head& a, const Head& b) const;
+
+  std::string order_field_;
+  bool descending_;
+  size_t limit_;
+  std::vector<std::unique_ptr<QueryIterator>> iterators_;
+  bool started_;
+  // The query whose document was returned last, and so isn't in the heap.
+  static const size_t kNoSource = static_cast<size_t>(-1);
+  size_t refill_;
+  std::vector<Head> heap_;
+  std::unordered_set<std::string> returned_;
+  size_t duplicates_;
+  firebase::firestore::Error error_;
+  std::string error_message_;
+};
+
+#endif  // FIREBASE_TESTAPP_MERGED_QUERY_H_  // NOLINT
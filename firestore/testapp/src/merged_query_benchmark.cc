@@ -0,0 +1,215 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmarks.h"    // NOLINT
+#include "bulk_writer.h"   // NOLINT
+#include "firebase/firestore.h"
+#include "firebase/future.h"
+#include "merged_query.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollMs = 1;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Runs the queries one after another and merges their results in memory, as
+// an app without MergedQuery would. Returns the paths of the merged
+// documents, or false if a query failed.
+bool RunSequentially(const std::vector<firebase::firestore::Query>& queries,
+                     int limit, std::vector<std::string>* paths,
+                     size_t* fetched) {
+  struct Result {
+    int64_t score;
+    std::string path;
+  };
+  std::vector<Result> results;
+  *fetched = 0;
+  for (const auto& query : queries) {
+    firebase::firestore::Query ordered = query.OrderBy("score");
+    if (limit > 0) ordered = ordered.Limit(limit);
+    firebase::Future<firebase::firestore::QuerySnapshot> future =
+        ordered.Get();
+    while (future.status() == firebase::kFutureStatusPending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+    if (future.status() != firebase::kFutureStatusComplete ||
+        future.error() != firebase::firestore::kErrorOk) {
+      LogMessage("ERROR: Query failed: %d (%s).", future.error(),
+                 future.error_message());
+      return false;
+    }
+    for (const auto& document : future.result()->documents()) {
+      results.push_back(Result{document.Get("score").integer_value(),
+                               document.reference().path()});
+    }
+    *fetched += future.result()->size();
+  }
+  std::sort(results.begin(), results.end(),
+            [](const Result& a, const Result& b) {
+              return a.score != b.score ? a.score < b.score : a.path < b.path;
+            });
+  std::unordered_set<std::string> seen;
+  paths->clear();
+  for (const auto& result : results) {
+    if (limit > 0 && paths->size() == static_cast<size_t>(limit)) break;
+    if (seen.insert(result.path).second) paths->push_back(result.path);
+  }
+  return true;
+}
+
+// Runs the queries with a MergedQuery. Returns the paths of the merged
+// documents, or false if a query failed.
+bool RunMerged(const std::vector<firebase::firestore::Query>& queries,
+               int limit, int page_size, std::vector<std::string>* paths,
+               size_t* fetched, size_t* duplicates) {
+  MergedQuery merged(queries, "score",
+                     firebase::firestore::Query::Direction::kAscending, limit,
+                     page_size);
+  paths->clear();
+  firebase::firestore::DocumentSnapshot document;
+  while (merged.Next(&document)) {
+    paths->push_back(document.reference().path());
+  }
+  *fetched = merged.documents_fetched();
+  *duplicates = merged.duplicates();
+  if (merged.error() != firebase::firestore::kErrorOk) {
+    LogMessage("ERROR: Merged query failed: %d (%s).", merged.error(),
+               merged.error_message().c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool RunMergedQueryBenchmark(firebase::firestore::Firestore* firestore,
+                             int argc, const char* argv[]) {
+  int num_documents = 2000;
+  int num_queries = 4;
+  int limit = 50;
+  int page_size = 100;
+  const char* documents_arg = GetArgument(argc, argv, "benchmark_documents");
+  if (documents_arg) num_documents = atoi(documents_arg);
+  const char* queries_arg = GetArgument(argc, argv, "benchmark_queries");
+  if (queries_arg) num_queries = atoi(queries_arg);
+  const char* limit_arg = GetArgument(argc, argv, "benchmark_limit");
+  if (limit_arg) limit = atoi(limit_arg);
+  const char* page_arg = GetArgument(argc, argv, "benchmark_page_size");
+  if (page_arg) page_size = atoi(page_arg);
+  if (num_documents <= 0 || num_queries <= 0 || limit <= 0 ||
+      page_size <= 0) {
+    LogMessage("ERROR: --benchmark_documents, --benchmark_queries, "
+               "--benchmark_limit and --benchmark_page_size must be "
+               "positive.");
+    return false;
+  }
+  LogMessage("Benchmarking the merge of %d overlapping queries over %d "
+             "documents.",
+             num_queries, num_documents);
+
+  firebase::firestore::CollectionReference collection =
+      firestore->Collection("benchmarks").Document().Collection("merge");
+  std::vector<firebase::firestore::DocumentReference> documents;
+  bool success;
+  {
+    BulkWriter writer(firestore);
+    for (int i = 0; i < num_documents; i++) {
+      documents.push_back(collection.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"score", firebase::firestore::FieldValue::Integer(i)}});
+    }
+    success = writer.Flush();
+  }
+  if (!success) {
+    LogMessage("ERROR: Unable to write the benchmark data.");
+    return false;
+  }
+
+  // Each query covers its share of the scores and half of the next share,
+  // so that about a third of the documents it matches are duplicates.
+  std::vector<firebase::firestore::Query> queries;
+  int share = std::max(num_documents / num_queries, 1);
+  for (int i = 0; i < num_queries; i++) {
+    queries.push_back(
+        collection
+            .WhereGreaterThanOrEqualTo(
+                "score", firebase::firestore::FieldValue::Integer(i * share))
+            .WhereLessThan("score", firebase::firestore::FieldValue::Integer(
+                                        (i + 1) * share + share / 2)));
+  }
+
+  for (int run_limit : {0, limit}) {
+    char label[32];
+    if (run_limit > 0) {
+      snprintf(label, sizeof(label), "limit %d", run_limit);
+    } else {
+      snprintf(label, sizeof(label), "no limit");
+    }
+    std::vector<std::string> sequential;
+    size_t fetched = 0;
+    Clock::time_point start = Clock::now();
+    success = RunSequentially(queries, run_limit, &sequential, &fetched) &&
+              success;
+    double sequential_seconds = SecondsSince(start);
+
+    std::vector<std::string> merged;
+    size_t merged_fetched = 0;
+    size_t duplicates = 0;
+    start = Clock::now();
+    success = RunMerged(queries, run_limit, page_size, &merged,
+                        &merged_fetched, &duplicates) &&
+              success;
+    double merged_seconds = SecondsSince(start);
+
+    LogMessage("  %s, sequential: %d documents in %.3f s, %d fetched.", label,
+               static_cast<int>(sequential.size()), sequential_seconds,
+               static_cast<int>(fetched));
+    LogMessage("  %s, merged: %d documents in %.3f s, %d fetched, %d "
+               "duplicates skipped.",
+               label, static_cast<int>(merged.size()), merged_seconds,
+               static_cast<int>(merged_fetched), static_cast<int>(duplicates));
+    if (merged != sequential) {
+      LogMessage("ERROR: The merged query returned different documents.");
+      success = false;
+    }
+  }
+
+  {
+    BulkWriter writer(firestore);
+    for (const auto& document : documents) writer.Delete(document);
+    success = writer.Flush() && success;
+  }
+  LogMessage(success ? "SUCCESS: Merged query benchmark complete."
+                     : "ERROR: Merged query benchmark failed.");
+  return success;
+}
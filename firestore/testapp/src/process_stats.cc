@@ -0,0 +1,149 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "process_stats.h"  // NOLINT
+
+#include <string>
+
+#if defined(FIREBASE_TESTAPP_COUNT_ALLOCATIONS)
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#endif  // defined(FIREBASE_TESTAPP_COUNT_ALLOCATIONS)
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <dirent.h>
+#include <mach/mach.h>
+#include <sys/stat.h>
+#elif defined(__linux__) || defined(__ANDROID__)
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#endif
+
+#if defined(FIREBASE_TESTAPP_COUNT_ALLOCATIONS)
+namespace {
+
+std::atomic<int64_t> g_allocation_count(0);
+
+}  // namespace
+
+// The other forms of operator new and delete, including the array and
+// nothrow ones, call these by default.
+void* operator new(size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  while (true) {
+    if (void* pointer = malloc(size ? size : 1)) return pointer;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void operator delete(void* pointer) noexcept { free(pointer); }
+
+// Since C++14 the compiler may call the sized form instead, which must then
+// be replaced too.
+void operator delete(void* pointer, std::size_t) noexcept { free(pointer); }
+#endif  // defined(FIREBASE_TESTAPP_COUNT_ALLOCATIONS)
+
+int64_t GetResidentMemoryBytes() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                               sizeof(counters))) {
+    return -1;
+  }
+  return static_cast<int64_t>(counters.WorkingSetSize);
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return -1;
+  }
+  return static_cast<int64_t>(info.resident_size);
+#elif defined(__linux__) || defined(__ANDROID__)
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm) return -1;
+  long pages = 0;     // NOLINT
+  long resident = 0;  // NOLINT
+  int fields = fscanf(statm, "%ld %ld", &pages, &resident);
+  fclose(statm);
+  if (fields != 2) return -1;
+  return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+#else
+  return -1;
+#endif
+}
+
+int64_t GetDirectorySize(const char* path) {
+#if defined(_WIN32)
+  std::string pattern = std::string(path) + "\\*";
+  WIN32_FIND_DATAA entry;
+  HANDLE find = FindFirstFileA(pattern.c_str(), &entry);
+  if (find == INVALID_HANDLE_VALUE) return -1;
+  int64_t total = 0;
+  do {
+    std::string name = entry.cFileName;
+    if (name == "." || name == "..") continue;
+    if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      std::string child = std::string(path) + "\\" + name;
+      int64_t size = GetDirectorySize(child.c_str());
+      if (size > 0) total += size;
+    } else {
+      total += (static_cast<int64_t>(entry.nFileSizeHigh) << 32) |
+               entry.nFileSizeLow;
+    }
+  } while (FindNextFileA(find, &entry));
+  FindClose(find);
+  return total;
+#elif defined(__APPLE__) || defined(__linux__) || defined(__ANDROID__)
+  DIR* directory = opendir(path);
+  if (!directory) return -1;
+  int64_t total = 0;
+  while (struct dirent* entry = readdir(directory)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    std::string child = std::string(path) + "/" + name;
+    struct stat info;
+    if (lstat(child.c_str(), &info) != 0) continue;
+    if (S_ISDIR(info.st_mode)) {
+      int64_t size = GetDirectorySize(child.c_str());
+      if (size > 0) total += size;
+    } else if (S_ISREG(info.st_mode)) {
+      total += static_cast<int64_t>(info.st_size);
+    }
+  }
+  closedir(directory);
+  return total;
+#else
+  (void)path;
+  return -1;
+#endif
+}
+
+int64_t GetAllocationCount() {
+#if defined(FIREBASE_TESTAPP_COUNT_ALLOCATIONS)
+  return g_allocation_count.load(std::memory_order_relaxed);
+#else
+  return -1;
+#endif  // defined(FIREBASE_TESTAPP_COUNT_ALLOCATIONS)
+}
@@ -0,0 +1,200 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query_aggregator.h"  // NOLINT
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "query_iterator.h"  // NOLINT
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+void QueryAggregator::Accumulator::Add(bool has_value, double value) {
+  documents_++;
+  if (!has_value) return;
+  count_++;
+  sum_ += value;
+  values_[value]++;
+}
+
+void QueryAggregator::Accumulator::Remove(bool has_value, double value) {
+  documents_--;
+  if (!has_value) return;
+  count_--;
+  sum_ -= value;
+  auto it = values_.find(value);
+  if (it != values_.end() && --it->second == 0) values_.erase(it);
+  // Start again from zero once the last value is gone, rather than leaving
+  // the rounding errors of every addition and removal behind.
+  if (!count_) sum_ = 0;
+}
+
+AggregateResult QueryAggregator::Accumulator::result() const {
+  AggregateResult result;
+  result.documents = documents_;
+  result.count = count_;
+  result.sum = sum_;
+  if (!values_.empty()) {
+    result.min = values_.begin()->first;
+    result.max = values_.rbegin()->first;
+  }
+  return result;
+}
+
+QueryAggregator::QueryAggregator(std::string value_field,
+                                 std::string group_field)
+    : value_field_(std::move(value_field)),
+      group_field_(std::move(group_field)) {}
+
+QueryAggregator::Contribution QueryAggregator::Contribute(
+    const firebase::firestore::DocumentSnapshot& document) const {
+  Contribution contribution;
+  firebase::firestore::FieldValue value = document.Get(value_field_);
+  if (value.is_integer()) {
+    contribution.has_value = true;
+    contribution.value = static_cast<double>(value.integer_value());
+  } else if (value.is_double() && !std::isnan(value.double_value())) {
+    // NaN has no place in the order of values_, and would make the sum NaN.
+    contribution.has_value = true;
+    contribution.value = value.double_value();
+  }
+  if (!group_field_.empty()) {
+    firebase::firestore::FieldValue group = document.Get(group_field_);
+    if (group.is_string()) {
+      contribution.group = group.string_value();
+    } else if (group.is_valid()) {
+      contribution.group = group.ToString();
+    }
+  }
+  return contribution;
+}
+
+void QueryAggregator::Add(
+    const firebase::firestore::DocumentSnapshot& document) {
+  Contribution contribution = Contribute(document);
+  std::string path = document.reference().path();
+  std::lock_guard<std::mutex> lock(mutex_);
+  AddLocked(std::move(path), std::move(contribution));
+}
+
+void QueryAggregator::Remove(
+    const firebase::firestore::DocumentSnapshot& document) {
+  std::string path = document.reference().path();
+  std::lock_guard<std::mutex> lock(mutex_);
+  RemoveLocked(path);
+}
+
+void QueryAggregator::AddLocked(std::string path,
+                                Contribution contribution) {
+  RemoveLocked(path);
+  total_.Add(contribution.has_value, contribution.value);
+  groups_[contribution.group].Add(contribution.has_value, contribution.value);
+  contributions_[std::move(path)] = std::move(contribution);
+}
+
+void QueryAggregator::RemoveLocked(const std::string& path) {
+  auto it = contributions_.find(path);
+  if (it == contributions_.end()) return;
+  const Contribution& contribution = it->second;
+  total_.Remove(contribution.has_value, contribution.value);
+  auto group = groups_.find(contribution.group);
+  group->second.Remove(contribution.has_value, contribution.value);
+  if (group->second.empty()) groups_.erase(group);
+  contributions_.erase(it);
+}
+
+void QueryAggregator::Apply(
+    const firebase::firestore::QuerySnapshot& snapshot) {
+  // Read the documents before taking the lock, then apply the whole
+  // snapshot at once, so that readers never see part of it.
+  struct Change {
+    std::string path;
+    bool removed;
+    Contribution contribution;
+  };
+  std::vector<Change> changes;
+  for (const auto& change : snapshot.DocumentChanges()) {
+    firebase::firestore::DocumentSnapshot document = change.document();
+    changes.push_back(Change());
+    changes.back().path = document.reference().path();
+    changes.back().removed =
+        change.type() == firebase::firestore::DocumentChange::Type::kRemoved;
+    if (!changes.back().removed) {
+      changes.back().contribution = Contribute(document);
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Change& change : changes) {
+    if (change.removed) {
+      RemoveLocked(change.path);
+    } else {
+      AddLocked(std::move(change.path), std::move(change.contribution));
+    }
+  }
+}
+
+void QueryAggregator::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  contributions_.clear();
+  total_ = Accumulator();
+  groups_.clear();
+}
+
+firebase::firestore::Error QueryAggregator::AddAll(
+    const firebase::firestore::Query& query, int page_size) {
+  QueryIterator iterator(query, page_size);
+  firebase::firestore::DocumentSnapshot document;
+  while (iterator.Next(&document)) Add(document);
+  return iterator.error();
+}
+
+firebase::firestore::ListenerRegistration QueryAggregator::Listen(
+    firebase::firestore::Query query,
+    std::function<void(const QueryAggregator&)> on_update) {
+  return query.AddSnapshotListener(
+      [this, on_update](const firebase::firestore::QuerySnapshot& snapshot,
+                        firebase::firestore::Error error,
+                        const std::string& error_message) {
+        if (error != firebase::firestore::kErrorOk) {
+          LogMessage("ERROR: Aggregation of %s failed: %d (%s).",
+                     value_field_.c_str(), error, error_message.c_str());
+          return;
+        }
+        Apply(snapshot);
+        if (on_update) on_update(*this);
+      });
+}
+
+AggregateResult QueryAggregator::total() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_.result();
+}
+
+AggregateResult QueryAggregator::group(const std::string& value) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = groups_.find(value);
+  return it == groups_.end() ? AggregateResult() : it->second.result();
+}
+
+std::map<std::string, AggregateResult> QueryAggregator::groups() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, AggregateResult> results;
+  for (const auto& group : groups_) {
+    results[group.first] = group.second.result();
+  }
+  return results;
+}
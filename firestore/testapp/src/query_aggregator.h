@@ -0,0 +1,127 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_QUERY_AGGREGATOR_H_  // NOLINT
+#define FIREBASE_TESTAPP_QUERY_AGGREGATOR_H_  // NOLINT
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "firebase/firestore.h"
+
+// The aggregates of a numeric field over a set of documents.
+struct AggregateResult {
+  double average() const { return count > 0 ? sum / count : 0; }
+
+  // Documents in the set, whether or not they have a numeric value.
+  size_t documents = 0;
+  // Documents with an integer or double value other than NaN, which the rest
+  // are over.
+  size_t count = 0;
+  double sum = 0;
+  double min = 0;
+  double max = 0;
+};
+
+// Computes the count, sum, average, minimum and maximum of a numeric field
+// over the results of a query, in total and grouped by the value of another
+// field, without keeping the documents.
+//
+// Documents are added one at a time, e.g. from a QueryIterator, or as the
+// changes of the snapshots delivered to a listener, so that keeping the
+// aggregates of a live query up to date costs O(changes) rather than a rescan
+// of every document. Only each document's contribution is kept, so that it
+// can be taken back out when the document changes or is removed.
+//
+// It is safe to update the aggregates from a listener while reading them on
+// another thread.
+class QueryAggregator {
+ public:
+  // Aggregates value_field, and if group_field isn't empty, groups the
+  // documents by its value.
+  explicit QueryAggregator(std::string value_field,
+                           std::string group_field = std::string());
+
+  // Adds a document, replacing what it contributed before if it was already
+  // added.
+  void Add(const firebase::firestore::DocumentSnapshot& document);
+  void Remove(const firebase::firestore::DocumentSnapshot& document);
+  // Applies the document changes of a query snapshot; the first snapshot of a
+  // listener adds every document.
+  void Apply(const firebase::firestore::QuerySnapshot& snapshot);
+  void Clear();
+
+  // Adds every document matched by query, reading page_size documents at a
+  // time with a QueryIterator. Returns the error of the request that failed,
+  // if any.
+  firebase::firestore::Error AddAll(const firebase::firestore::Query& query,
+                                    int page_size);
+
+  // Keeps the aggregates up to date with the results of query until the
+  // registration is removed. on_update, if given, is called on the
+  // listener's thread after each snapshot has been applied.
+  firebase::firestore::ListenerRegistration Listen(
+      firebase::firestore::Query query,
+      std::function<void(const QueryAggregator&)> on_update = nullptr);
+
+  AggregateResult total() const;
+  // Returns the aggregates of the documents whose group field has value:
+  // the string itself for string fields, FieldValue::ToString() for others.
+  // Documents without the field are grouped under an empty string.
+  AggregateResult group(const std::string& value) const;
+  std::map<std::string, AggregateResult> groups() const;
+
+ private:
+  // The values in a set of documents, counted by value so that the minimum
+  // and maximum are known after a value is removed.
+  class Accumulator {
+   public:
+    void Add(bool has_value, double value);
+    void Remove(bool has_value, double value);
+    bool empty() const { return documents_ == 0; }
+    AggregateResult result() const;
+
+   private:
+    size_t documents_ = 0;
+    size_t count_ = 0;
+    double sum_ = 0;
+    std::map<double, size_t> values_;
+  };
+
+  // What a document added to the aggregates.
+  struct Contribution {
+    std::string group;
+    bool has_value = false;
+    double value = 0;
+  };
+
+  Contribution Contribute(
+      const firebase::firestore::DocumentSnapshot& document) const;
+  void AddLocked(std::string path, Contribution contribution);
+  void RemoveLocked(const std::string& path);
+
+  std::string value_field_;
+  std::string group_field_;
+  mutable std::mutex mutex_;
+  // Keyed by document path.
+  std::unordered_map<std::string, Contribution> contributions_;
+  Accumulator total_;
+  std::map<std::string, Accumulator> groups_;
+};
+
+#endif  // FIREBASE_TESTAPP_QUERY_AGGREGATOR_H_  // NOLINT
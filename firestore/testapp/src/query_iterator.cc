@@ -0,0 +1,104 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query_iterator.h"  // NOLINT
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kPollMs = 1;
+
+}  // namespace
+
+QueryIterator::QueryIterator(const firebase::firestore::Query& query,
+                             int page_size, int limit)
+    : query_(query),
+      page_size_(page_size > 0 ? page_size : 1),
+      limit_(limit > 0 ? static_cast<size_t>(limit) : 0),
+      pending_size_(0),
+      done_(false),
+      error_(firebase::firestore::kErrorOk),
+      pages_read_(0),
+      documents_read_(0),
+      documents_fetched_(0),
+      wait_seconds_(0) {
+  RequestPage(nullptr);
+}
+
+bool QueryIterator::Next(firebase::firestore::DocumentSnapshot* document) {
+  while (page_.empty()) {
+    if (done_ || !ReceivePage()) return false;
+  }
+  *document = std::move(page_.front());
+  page_.pop_front();
+  documents_read_++;
+  return true;
+}
+
+bool QueryIterator::ReceivePage() {
+  if (pending_.status() == firebase::kFutureStatusPending) {
+    Clock::time_point start = Clock::now();
+    while (pending_.status() == firebase::kFutureStatusPending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+    wait_seconds_ +=
+        std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  if (pending_.status() != firebase::kFutureStatusComplete ||
+      pending_.error() != firebase::firestore::kErrorOk) {
+    error_ = pending_.status() == firebase::kFutureStatusComplete
+                 ? static_cast<firebase::firestore::Error>(pending_.error())
+                 : firebase::firestore::kErrorUnknown;
+    error_message_ = pending_.error_message() ? pending_.error_message() : "";
+    pending_.Release();
+    done_ = true;
+    return false;
+  }
+
+  std::vector<firebase::firestore::DocumentSnapshot> documents =
+      pending_.result()->documents();
+  pages_read_++;
+  documents_fetched_ += documents.size();
+  // A short page means the end of the result has been reached, and once the
+  // limit is reached no more documents are needed; otherwise prefetch the
+  // next page while the caller works on this one. Either way the future's
+  // copy of the page is dropped so that each document is only held by page_.
+  if (documents.size() < pending_size_ ||
+      (limit_ && documents_fetched_ >= limit_)) {
+    pending_.Release();
+    done_ = true;
+  } else {
+    RequestPage(&documents.back());
+  }
+  page_.assign(std::make_move_iterator(documents.begin()),
+               std::make_move_iterator(documents.end()));
+  return true;
+}
+
+void QueryIterator::RequestPage(
+    const firebase::firestore::DocumentSnapshot* after) {
+  pending_size_ = static_cast<size_t>(page_size_);
+  if (limit_) {
+    pending_size_ = std::min(pending_size_, limit_ - documents_fetched_);
+  }
+  firebase::firestore::Query page = after ? query_.StartAfter(*after) : query_;
+  pending_ = page.Limit(static_cast<int>(pending_size_)).Get();
+}
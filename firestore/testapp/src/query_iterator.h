@@ -0,0 +1,88 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_TESTAPP_QUERY_ITERATOR_H_  // NOLINT
+#define FIREBASE_TESTAPP_QUERY_ITERATOR_H_  // NOLINT
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+#include "firebase/firestore.h"
+#include "firebase/future.h"
+
+// Iterates over the documents matched by a query a page at a time, instead of
+// materializing the whole result with QuerySnapshot::documents().
+//
+// Each page is fetched with Limit(page_size).StartAfter(last document of the
+// previous page), and the request for the next page is issued as soon as the
+// previous one arrives, so that it downloads while the caller works through
+// the current one. Documents are released as they are handed out, so at most
+// two pages are held in memory at once however large the result is.
+//
+//   QueryIterator documents(collection.OrderBy("name"), 500);
+//   firebase::firestore::DocumentSnapshot document;
+//   while (documents.Next(&document)) Process(document);
+//   if (documents.error() != firebase::firestore::kErrorOk) ...
+//
+// The query must not have a limit or a start cursor of its own. Instead, a
+// limit can be given to the iterator, which then never requests more than
+// that many documents, and doesn't prefetch once it has them all.
+class QueryIterator {
+ public:
+  // A limit of 0 reads every document.
+  QueryIterator(const firebase::firestore::Query& query, int page_size,
+                int limit = 0);
+
+  // Stores the next document in document, waiting for its page if needed.
+  // Returns false once every document has been read, or if a request failed,
+  // in which case error() describes the failure.
+  bool Next(firebase::firestore::DocumentSnapshot* document);
+
+  firebase::firestore::Error error() const { return error_; }
+  const std::string& error_message() const { return error_message_; }
+  size_t pages_read() const { return pages_read_; }
+  size_t documents_read() const { return documents_read_; }
+  // Documents received in pages, including those not handed out yet.
+  size_t documents_fetched() const { return documents_fetched_; }
+  // Time Next() spent waiting for pages that hadn't arrived yet. Close to zero
+  // when the caller is slower than the prefetch.
+  double wait_seconds() const { return wait_seconds_; }
+
+ private:
+  // Waits for the pending page and, unless it is the last one, requests the
+  // one after it. Returns false if the request failed.
+  bool ReceivePage();
+  // Requests the page after the given document, or the first page if it is
+  // null, without going past the limit.
+  void RequestPage(const firebase::firestore::DocumentSnapshot* after);
+
+  firebase::firestore::Query query_;
+  int page_size_;
+  size_t limit_;
+  firebase::Future<firebase::firestore::QuerySnapshot> pending_;
+  // The number of documents pending_ asked for.
+  size_t pending_size_;
+  // Documents of the current page that haven't been handed out yet.
+  std::deque<firebase::firestore::DocumentSnapshot> page_;
+  bool done_;
+  firebase::firestore::Error error_;
+  std::string error_message_;
+  size_t pages_read_;
+  size_t documents_read_;
+  size_t documents_fetched_;
+  double wait_seconds_;
+};
+
+#endif  // FIREBASE_TESTAPP_QUERY_ITERATOR_H_  // NOLINT
@@ -0,0 +1,97 @@
+// Copyright 2026 Google Inc. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"          // NOLINT
+#include "bulk_writer.h"         // NOLINT
+#include "collection_scanner.h"  // NOLINT
+#include "firebase/firestore.h"
+
+// Thin OS abstraction layer.
+#include "main.h"  // NOLINT
+
+bool RunScanBenchmark(firebase::firestore::Firestore* firestore, int argc,
+                      const char* argv[]) {
+  int num_documents = 5000;
+  int max_partitions = 16;
+  ScanOptions options;
+  const char* documents_arg = GetArgument(argc, argv, "benchmark_documents");
+  if (documents_arg) num_documents = atoi(documents_arg);
+  const char* partitions_arg =
+      GetArgument(argc, argv, "benchmark_max_partitions");
+  if (partitions_arg) max_partitions = atoi(partitions_arg);
+  const char* page_arg = GetArgument(argc, argv, "benchmark_page_size");
+  if (page_arg) options.page_size = atoi(page_arg);
+  if (num_documents <= 0 || max_partitions <= 0 || options.page_size <= 0) {
+    LogMessage("ERROR: --benchmark_documents, --benchmark_max_partitions and "
+               "--benchmark_page_size must be positive.");
+    return false;
+  }
+  LogMessage("Benchmarking scans of %d documents with up to %d partitions, "
+             "%d documents per page.",
+             num_documents, max_partitions, options.page_size);
+
+  firebase::firestore::CollectionReference collection =
+      firestore->Collection("benchmarks").Document().Collection("scan");
+  std::vector<firebase::firestore::DocumentReference> documents;
+  bool success;
+  {
+    BulkWriter writer(firestore);
+    for (int i = 0; i < num_documents; i++) {
+      documents.push_back(collection.Document());
+      writer.Set(documents.back(),
+                 firebase::firestore::MapFieldValue{
+                     {"index", firebase::firestore::FieldValue::Integer(i)}});
+    }
+    success = writer.Flush();
+  }
+  if (!success) {
+    LogMessage("ERROR: Unable to write the benchmark data.");
+    return false;
+  }
+
+  for (int partitions = 1; partitions <= max_partitions; partitions *= 2) {
+    size_t consumed = 0;
+    ScanStats stats;
+    success = ScanCollection(
+                  collection, AutoIdSplitPoints(partitions), options,
+                  [&consumed](const firebase::firestore::DocumentSnapshot&) {
+                    consumed++;
+                  },
+                  &stats) &&
+              success;
+    LogMessage("  %d partitions: %d documents in %.2f s, %.0f documents/s, "
+               "%d pages, %d waits for the consumer.",
+               partitions, static_cast<int>(stats.documents), stats.seconds,
+               stats.documents_per_second(), static_cast<int>(stats.pages),
+               static_cast<int>(stats.full_queue_waits));
+    if (consumed != static_cast<size_t>(num_documents)) {
+      LogMessage("ERROR: The scan read %d documents, expected %d.",
+                 static_cast<int>(consumed), num_documents);
+      success = false;
+    }
+  }
+
+  {
+    BulkWriter writer(firestore);
+    for (const auto& document : documents) writer.Delete(document);
+    success = writer.Flush() && success;
+  }
+  LogMessage(success ? "SUCCESS: Scan benchmark complete."
+                     : "ERROR: Scan benchmark failed.");
+  return success;
+}